@@ -1,24 +1,138 @@
 #include "file_image.h"
 #include <fstream>
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+struct FileImage::Storage
+{
+	image_t buffer;
+	void *map = nullptr;
+	size_t map_size = 0;
+
+	Storage() = default;
+	Storage(const Storage &) = delete;
+	Storage &operator=(const Storage &) = delete;
+
+	~Storage()
+	{
+		if (!map)
+			return;
+#ifdef _WIN32
+		UnmapViewOfFile(map);
+#else
+		munmap(map, map_size);
+#endif
+	}
+
+	const char *data() const noexcept { return map ? static_cast<const char *>(map) : buffer.data(); }
+	size_t size() const noexcept { return map ? map_size : buffer.size(); }
+};
+
+/**
+ * Map a regular file read-only. Returns false if the file cannot be mapped
+ * (pipes, character devices, empty files) so that the caller falls back to reading it.
+ */
+static bool map_file(const std::string &name, void *&map, size_t &map_size)
+{
+#ifdef _WIN32
+	auto file = CreateFileA(name.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	auto size = LARGE_INTEGER();
+	if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &size) || !size.QuadPart)
+	{
+		CloseHandle(file);
+		return false;
+	}
+	auto mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (!mapping)
+		return false;
+	map = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (!map)
+		return false;
+	map_size = size_t(size.QuadPart);
+	return true;
+#else
+	auto fd = open(name.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if (fstat(fd, &st) || !S_ISREG(st.st_mode) || !st.st_size)
+	{
+		close(fd);
+		return false;
+	}
+	auto p = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED)
+		return false;
+	map = p;
+	map_size = size_t(st.st_size);
+	return true;
+#endif
+}
+
 FileImage::FileImage(std::string_view name)
 {
-	auto in = std::ifstream(name.data(), std::ios_base::binary);
-	m_Image.assign((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	auto storage = std::make_shared<Storage>();
+	if (name == "-")
+	{
+#ifdef _WIN32
+		_setmode(_fileno(stdin), _O_BINARY);
+#endif
+		storage->buffer.assign((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+	}
+	else if (!map_file(std::string(name), storage->map, storage->map_size))
+	{
+		auto in = std::ifstream(std::string(name), std::ios_base::binary);
+		storage->buffer.assign((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	}
+	m_Data = storage->data();
+	m_Size = storage->size();
+	m_Storage = std::move(storage);
 	m_FP = 0;
 }
 
+bool FileImage::IsMapped() const noexcept { return m_Storage && m_Storage->map; }
+
+void FileImage::Advise(Access access) const
+{
+#ifndef _WIN32
+	if (!IsMapped())
+		return;
+	auto advice = MADV_NORMAL;
+	if (access == Access::Sequential)
+		advice = MADV_SEQUENTIAL;
+	else if (access == Access::Random)
+		advice = MADV_RANDOM;
+	madvise(m_Storage->map, m_Storage->map_size, advice);
+#endif
+}
+
 void FileImage::Seek(size_t pos)
 {
-	if (pos >= m_Image.size())
-		pos = m_Image.size() - 1;
+	if (pos >= m_Size)
+		pos = m_Size ? m_Size - 1 : 0;
 	m_FP = pos;
 }
 
 void FileImage::Skip()
 {
-	const auto zero = m_Image.data();
-	const auto max = zero + m_Image.size();
+	const auto zero = m_Data;
+	const auto max = zero + m_Size;
 	auto p = zero + m_FP;
 	for (; p < max && (!*p || *p == ' ' || *p == '\t' || *p == '\r' || *p == '\n' || *p == '\f'); ++p)
 		;
@@ -27,8 +141,8 @@ void FileImage::Skip()
 
 void FileImage::Skip(size_t step)
 {
-	const auto zero = m_Image.data();
-	const auto max = zero + m_Image.size();
+	const auto zero = m_Data;
+	const auto max = zero + m_Size;
 	auto p = zero + m_FP;
 	p += step;
 	if (p >= max)
@@ -38,37 +152,50 @@ void FileImage::Skip(size_t step)
 
 void FileImage::Skip(std::string_view delim)
 {
-	const auto zero = m_Image.data();
-	const auto max = zero + m_Image.size();
+	const auto zero = m_Data;
+	const auto max = zero + m_Size;
 	auto head = zero + m_FP;
 	auto tail = head;
-	for (; delim.find_first_of(*tail) == delim.npos; ++tail)
-		if (tail >= max)
-			break;
+	for (; tail < max && delim.find_first_of(*tail) == delim.npos; ++tail)
+		;
 	m_FP = tail - zero;
 }
 
+char FileImage::Get()
+{
+	if (m_FP >= m_Size)
+		throw std::out_of_range("unexpected end of image.");
+	return m_Data[m_FP++];
+}
+
 bool FileImage::Check(std::string_view token, bool step)
 {
-	if (std::string_view(&m_Image[m_FP], token.size()) != token)
+	if (m_Size - m_FP < token.size() || std::string_view(m_Data + m_FP, token.size()) != token)
 		return false;
 	if (step)
 		m_FP += token.size();
 	return true;
 }
 
-std::cmatch FileImage::Check(std::regex reg)
+bool FileImage::GetUnsigned(size_t &value, bool step)
 {
-	auto m = std::cmatch();
-	std::regex_search(&m_Image[m_FP], m, reg);
-	return m;
+	auto p = m_FP;
+	auto v = size_t(0);
+	for (; p < m_Size && m_Data[p] >= '0' && m_Data[p] <= '9'; ++p)
+		v = v * 10 + (m_Data[p] - '0');
+	if (p == m_FP)
+		return false;
+	value = v;
+	if (step)
+		m_FP = p;
+	return true;
 }
 
 std::string_view FileImage::GetLine(size_t size, bool step)
 {
 	Skip();
-	const auto zero = m_Image.data();
-	const auto max = zero + m_Image.size();
+	const auto zero = m_Data;
+	const auto max = zero + m_Size;
 	auto head = zero + m_FP;
 	if (head + size > max)
 		size = max - head;
@@ -80,8 +207,8 @@ std::string_view FileImage::GetLine(size_t size, bool step)
 std::string_view FileImage::GetLine(std::string_view delim, bool step)
 {
 	Skip();
-	const auto zero = m_Image.data();
-	const auto max = zero + m_Image.size();
+	const auto zero = m_Data;
+	const auto max = zero + m_Size;
 	auto head = zero + m_FP;
 	auto tail = head;
 	for (; tail < max && delim.find_first_of(*tail) == delim.npos; ++tail)
@@ -91,40 +218,30 @@ std::string_view FileImage::GetLine(std::string_view delim, bool step)
 	return std::string_view(head, tail - head);
 }
 
-std::cmatch FileImage::GetLine(std::regex reg, bool step)
-{
-	Skip();
-	auto m = std::cmatch();
-	if (std::regex_search(&m_Image[m_FP], m, reg))
-		if (step)
-			m_FP += m.position(0) + m.length(0);
-	return m;
-}
-
 std::string_view FileImage::GetLine()
 {
 	Skip();
-	const auto zero = m_Image.data();
-	const auto max = zero + m_Image.size();
+	const auto zero = m_Data;
+	const auto max = zero + m_Size;
 	auto head = zero + m_FP;
 	auto tail = head;
 	for (; tail < max && *tail != '\r' && *tail != '\n'; ++tail)
 		;
-	for (m_FP = tail - zero; m_Image[m_FP] == '\r' || m_Image[m_FP] == '\n'; ++m_FP)
+	for (m_FP = tail - zero; m_FP < m_Size && (m_Data[m_FP] == '\r' || m_Data[m_FP] == '\n'); ++m_FP)
 		;
 	return std::string_view(head, tail - head);
 }
 
 std::string_view FileImage::GetLineBack()
 {
-	const auto zero = m_Image.data();
+	const auto zero = m_Data;
 	auto tail = zero + m_FP;
 	for (; *tail == '\r' || *tail == '\n'; --tail)
-		if (tail < zero)
+		if (tail <= zero)
 			throw std::out_of_range("not found tail.");
 	auto head = tail;
 	for (; *head != '\r' && *head != '\n'; --head)
-		if (head < zero)
+		if (head <= zero)
 			throw std::out_of_range("not found head.");
 	m_FP = head - zero;
 	return std::string_view(head + 1, tail - head);
@@ -1,9 +1,9 @@
 #pragma once
 
 #include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
-#include <regex>
 
 class FileImage
 {
@@ -11,9 +11,32 @@ public:
 	static const size_t End = -1;
 	using image_t = std::vector<char>;
 
+	enum class Access
+	{
+		Normal,
+		Sequential,
+		Random,
+	};
+
 public:
+	/**
+	 * Regular files are mapped read-only; pipes, stdin ("-") and anything
+	 * that cannot be mapped are read into memory instead.
+	 */
 	FileImage(std::string_view name);
 
+	/**
+	 * View a buffer owned by someone else, e.g. a decoded object stream.
+	 */
+	FileImage(const char *data, size_t size) : m_Data(data), m_Size(size), m_FP(0) {}
+
+	/**
+	 * Copies share the image and get their own cursor.
+	 */
+	FileImage(const FileImage &r) = default;
+
+	void Advise(Access access) const;
+
 	void Seek(size_t pos);
 	size_t Tell() const noexcept { return m_FP; }
 
@@ -21,23 +44,28 @@ public:
 	void Skip(size_t step);
 	void Skip(std::string_view delim);
 
-	char GetCH() const { return m_Image[m_FP]; }
-	char Get() { return m_Image[m_FP++]; }
+	char GetCH() const noexcept { return m_FP < m_Size ? m_Data[m_FP] : 0; }
+	char Get();
 	void Unget() { --m_FP; }
 
 	bool Check(std::string_view token, bool step = true);
-	std::cmatch Check(std::regex reg);
+	bool GetUnsigned(size_t &value, bool step = true);
 
 	std::string_view GetLine(size_t size, bool step = true);
 	std::string_view GetLine(std::string_view delim, bool step = true);
-	std::cmatch GetLine(std::regex reg, bool step = true);
-	
+
 	std::string_view GetLine();
 	std::string_view GetLineBack();
 
-	const image_t &Image() const { return m_Image; }
+	const char *Data() const noexcept { return m_Data; }
+	size_t Size() const noexcept { return m_Size; }
+	bool IsMapped() const noexcept;
 
 private:
-	image_t m_Image;
+	struct Storage;
+
+	std::shared_ptr<const Storage> m_Storage;
+	const char *m_Data;
+	size_t m_Size;
 	size_t m_FP;
 };
@@ -1,22 +1,467 @@
 #include "pdf.h"
+#include "pdf_compare.h"
+#include "parallel_for.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using clock_type = std::chrono::steady_clock;
+
+static double seconds_since(clock_type::time_point begin)
+{
+	return std::chrono::duration<double>(clock_type::now() - begin).count();
+}
+
+/**
+ * One side of the comparison. It is opened and listed on its own thread; the
+ * listing is kept until both sides are done so the output order never changes.
+ * Comparing a single page skips the listing, which would load every object,
+ * and so do reports that are not text.
+ */
+struct Side
+{
+	std::string_view name;
+	std::optional<PDF::Document> doc;
+	std::string listing;
+	std::exception_ptr error;
+	double load = 0;
+	double list = 0;
+
+	void Load(const PDF::Options &options, bool listed)
+	{
+		try
+		{
+			auto begin = clock_type::now();
+			doc.emplace(name, options);
+			load = seconds_since(begin);
+
+			if (!listed || options.page != PDF::Options::all_pages)
+				return;
+
+			begin = clock_type::now();
+			auto out = std::ostringstream();
+			out << *doc;
+			listing = out.str();
+			list = seconds_since(begin);
+		}
+		catch (...)
+		{
+			error = std::current_exception();
+		}
+	}
+};
+
+static void usage()
+{
+	puts("usage > cmppdf [options] [first.pdf|-] [second.pdf|-]");
+	puts("        cmppdf [options] --batch manifest.txt");
+	puts("        cmppdf [options] --revisions N file.pdf");
+	puts("        cmppdf [options] --structure file.pdf");
+	puts("  --batch F  compare every pair listed in F, one \"left<TAB>right\" per line,");
+	puts("             on --jobs threads (default: all cores); prints one");
+	puts("             \"same|differ|error<TAB>left<TAB>right[<TAB>message]\" line per");
+	puts("             pair and exits with 0 if all are the same, 1 if some");
+	puts("             differ and 2 if some failed");
+	puts("  --cache D  keep fingerprints of the first (golden) files in directory D");
+	puts("             and compare against them without opening those files again;");
+	puts("             a cached first file is not listed and its changed objects");
+	puts("             are only named (not with --semantic, --operators or --page)");
+	puts("  --decoded  compare streams after applying their filters");
+	puts("  --eager    parse every object while opening");
+	puts("  --format F write the differences as \"text\" (default), \"ndjson\" (one");
+	puts("             JSON object per difference, with its path) or \"binary\";");
+	puts("             only text comes with the object listings");
+	puts("  --jobs N   pre-decode objects on N threads");
+	puts("  --operators compare the content of every page operator by operator");
+	puts("  --page N   compare only page N (from 0) and the objects it uses, found");
+	puts("             through the hint tables of linearized files; no listing");
+	puts("  --quiet    print nothing; exit with 0 if the documents are the same, 1 if");
+	puts("             they differ and 2 on errors, stopping at the first difference");
+	puts("  --ranges N list every changed byte range of a stream, merging");
+	puts("             ranges at most N bytes apart");
+	puts("  --revisions N list what the last N incremental updates of a file changed");
+	puts("  --semantic match pages and objects by structure, not by object number");
+	puts("  --stats    print how many objects were materialized and copied");
+	puts("  --structure list the catalog, page tree and page resources of a file");
+	puts("  --timing   print the time spent in each phase");
+}
+
+static void print_statistics(std::string_view name, const PDF::Document &doc)
+{
+	const auto &stats = doc.GetStatistics();
+	const auto &arena = doc.GetArena();
+	std::cerr << name << ": " << stats.objects << " of " << doc.GetXrefSize() << " objects materialized, "
+			  << stats.object_streams << " object streams inflated, "
+			  << arena.GetAllocations() << " allocations (" << arena.GetBytes() << " bytes) in " << arena.GetChunks() << " arena chunks, "
+			  << (stats.objects ? arena.GetBytes() / stats.objects : 0) << " bytes per object" << std::endl;
+}
+
+/**
+ * One line of a batch manifest.
+ */
+struct Pair
+{
+	std::string left;
+	std::string right;
+
+	enum Result
+	{
+		Same,
+		Differ,
+		Error,
+	} result = Error;
+	std::string message;
+	bool done = false;
+};
+
+/**
+ * Pairs are "left<TAB>right"; paths without spaces may also be separated by
+ * blanks. Empty lines and lines starting with '#' are skipped.
+ */
+static std::vector<Pair> read_manifest(const std::string &name)
+{
+	auto in = std::ifstream(name);
+	if (!in)
+		throw std::runtime_error("cannot open " + name);
+
+	auto pairs = std::vector<Pair>();
+	auto line = std::string();
+	for (auto line_no = 1; std::getline(in, line); ++line_no)
+	{
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		auto pair = Pair();
+		auto tab = line.find('\t');
+		if (tab != std::string::npos)
+		{
+			pair.left = line.substr(0, tab);
+			pair.right = line.substr(tab + 1);
+		}
+		else
+		{
+			auto in_line = std::istringstream(line);
+			auto rest = std::string();
+			in_line >> pair.left >> pair.right;
+			if (in_line >> rest)
+				pair.right.clear();
+		}
+		if (pair.left.empty() || pair.right.empty())
+			throw std::runtime_error(name + ":" + std::to_string(line_no) + ": need two files.");
+		pairs.push_back(std::move(pair));
+	}
+	return pairs;
+}
+
+/**
+ * With a cache, the left side is taken as the golden one and its fingerprint
+ * stands in for it.
+ */
+static bool same_pair(const Pair &pair, const PDF::Options &options, const PDF::FingerprintCache *cache, std::atomic<size_t> &hits)
+{
+	if (cache)
+	{
+		auto golden = cache->Find(pair.left, options.decoded);
+		if (golden)
+			++hits;
+		else
+		{
+			golden = PDF::Document(pair.left, options).GetFingerprint();
+			cache->Store(pair.left, *golden);
+		}
+		return PDF::Document(pair.right, options).Matches(*golden);
+	}
+
+	auto left = PDF::Document(pair.left, options);
+	auto right = PDF::Document(pair.right, options);
+
+	// Page level comparisons are only expressed by the report itself.
+	if (options.semantic || options.operators || options.page != PDF::Options::all_pages)
+	{
+		auto report = PDF::DiffReport();
+		left.diff(report, right);
+		return report.empty();
+	}
+	return left == right;
+}
+
+/**
+ * Compare the pairs of a manifest on a fixed pool of `jobs` threads. Each
+ * thread holds one pair open at a time, so memory is bounded by the pool
+ * size, not by the manifest. Results are printed in manifest order as soon
+ * as all earlier pairs are done.
+ */
+static int run_batch(const std::string &manifest, PDF::Options options, size_t jobs, const PDF::FingerprintCache *cache, bool quiet)
+{
+	auto begin = clock_type::now();
+	auto pairs = read_manifest(manifest);
+
+	// The pool is the parallelism; every document is loaded on its own thread.
+	options.jobs = 1;
+
+	auto output_lock = std::mutex();
+	auto printed = size_t(0);
+	auto counts = std::vector<size_t>(3);
+	auto hits = std::atomic<size_t>(0);
+	auto print = [&](const Pair &pair) {
+		static const char *const labels[] = {"same", "differ", "error"};
+		++counts[pair.result];
+		if (quiet)
+			return;
+		std::cout << labels[pair.result] << '\t' << pair.left << '\t' << pair.right;
+		if (!pair.message.empty())
+			std::cout << '\t' << pair.message;
+		std::cout << '\n';
+	};
+
+	parallel_for(pairs.size(), jobs, [&](size_t i) {
+		auto &pair = pairs[i];
+		try
+		{
+			pair.result = same_pair(pair, options, cache, hits) ? Pair::Same : Pair::Differ;
+		}
+		catch (const std::exception &e)
+		{
+			pair.result = Pair::Error;
+			pair.message = e.what();
+		}
+
+		auto lock = std::lock_guard<std::mutex>(output_lock);
+		pair.done = true;
+		for (; printed < pairs.size() && pairs[printed].done; ++printed)
+		{
+			print(pairs[printed]);
+			// Nothing but the counts is needed any more.
+			pairs[printed] = Pair();
+		}
+	});
+	std::cout.flush();
+
+	if (!quiet)
+		std::cerr << "pairs: " << pairs.size() << ", same: " << counts[Pair::Same] << ", differ: " << counts[Pair::Differ] << ", error: " << counts[Pair::Error]
+				  << (cache ? ", cache hits: " + std::to_string(hits) : std::string())
+				  << std::fixed << std::setprecision(3) << " (" << seconds_since(begin) << " s on " << std::min(jobs, std::max<size_t>(pairs.size(), 1)) << " threads)" << std::endl;
+
+	if (counts[Pair::Error])
+		return 2;
+	return counts[Pair::Differ] ? 1 : 0;
+}
 
 int main(int argc, char *argv[])
 {
-	if (argc != 3)
+	auto options = PDF::Options();
+	auto stats = false;
+	auto timing = false;
+	auto quiet = false;
+	auto format = std::string_view("text");
+	auto batch = std::string();
+	auto cache_directory = std::string();
+	auto jobs_given = false;
+	auto revisions = size_t(0);
+	auto structure = false;
+	auto files = std::vector<std::string_view>();
+
+	for (auto i = 1; i < argc; ++i)
+	{
+		auto arg = std::string_view(argv[i]);
+		if (arg == "--batch" && i + 1 < argc)
+			batch = argv[++i];
+		else if (arg == "--cache" && i + 1 < argc)
+			cache_directory = argv[++i];
+		else if (arg == "--decoded")
+			options.decoded = true;
+		else if (arg == "--eager")
+			options.eager = true;
+		else if (arg == "--format" && i + 1 < argc)
+			format = argv[++i];
+		else if (arg == "--jobs" && i + 1 < argc)
+		{
+			options.jobs = std::max(1, atoi(argv[++i]));
+			jobs_given = true;
+		}
+		else if (arg == "--operators")
+			options.operators = true;
+		else if (arg == "--page" && i + 1 < argc)
+			options.page = size_t(std::max(0, atoi(argv[++i])));
+		else if (arg == "--ranges" && i + 1 < argc)
+			PDF::Stream::SetRangeGranularity(size_t(std::max(0, atoi(argv[++i]))));
+		else if (arg == "--revisions" && i + 1 < argc)
+			revisions = size_t(std::max(1, atoi(argv[++i])));
+		else if (arg == "--quiet")
+			quiet = true;
+		else if (arg == "--semantic")
+			options.semantic = true;
+		else if (arg == "--stats")
+			stats = true;
+		else if (arg == "--structure")
+			structure = true;
+		else if (arg == "--timing")
+			timing = true;
+		else if (arg.size() > 2 && arg.substr(0, 2) == "--")
+		{
+			usage();
+			return 1;
+		}
+		else
+			files.push_back(arg);
+	}
+
+	auto writer = PDF::ReportWriter::Create(format, std::cout);
+	if (!writer)
+	{
+		usage();
+		return 1;
+	}
+
+	// Fingerprints cannot stand in for the page content.
+	auto cache = std::optional<PDF::FingerprintCache>();
+	if (!cache_directory.empty() && !options.semantic && !options.operators && options.page == PDF::Options::all_pages)
+		cache.emplace(cache_directory);
+
+	if (!batch.empty() && files.empty())
 	{
-		puts("usage > cmppdf [first.pdf] [second.pdf]");
+		try
+		{
+			auto jobs = jobs_given ? options.jobs : size_t(std::max(1u, std::thread::hardware_concurrency()));
+			return run_batch(batch, options, jobs, cache ? &*cache : nullptr, quiet);
+		}
+		catch (const std::exception &e)
+		{
+			if (!quiet)
+				std::cerr << e.what() << std::endl;
+			return 2;
+		}
+	}
+
+	// Only the answer: neither listing nor report.
+	if (quiet && files.size() == 2)
+	{
+		try
+		{
+			auto pair = Pair();
+			pair.left = files[0];
+			pair.right = files[1];
+			auto hits = std::atomic<size_t>(0);
+			return same_pair(pair, options, cache ? &*cache : nullptr, hits) ? 0 : 1;
+		}
+		catch (const std::exception &)
+		{
+			return 2;
+		}
+	}
+
+	if ((revisions || structure) && files.size() == 1)
+	{
+		try
+		{
+			auto doc = PDF::Document(files[0], options);
+			auto report = PDF::DiffReport();
+			if (revisions)
+				doc.DiffRevisions(report, revisions);
+			else
+				doc.Traverse(report);
+			writer->Write(report);
+		}
+		catch (const std::exception &e)
+		{
+			std::cerr << e.what() << std::endl;
+		}
+		return 0;
+	}
+
+	if (files.size() != 2)
+	{
+		usage();
 		return 1;
 	}
 
 	try
 	{
-		auto first = PDF::Document(argv[1]);
-		std::cout << first;
-		auto second = PDF::Document(argv[2]);
-		std::cout << second;
+		auto total = clock_type::now();
+
+		// Both documents are independent until the diff, so open them concurrently.
+		auto sides = std::vector<Side>(2);
+		sides[0].name = files[0];
+		sides[1].name = files[1];
+
+		// A cached first file is neither opened nor listed.
+		auto golden = std::optional<PDF::Fingerprint>();
+		if (cache && files[0] != "-")
+			golden = cache->Find(std::string(files[0]), options.decoded);
+
+		auto begin = clock_type::now();
+		auto listed = format == "text";
+		auto worker = std::thread([&] { sides[1].Load(options, listed); });
+		if (!golden)
+			sides[0].Load(options, listed);
+		worker.join();
+		auto load = seconds_since(begin);
+
+		begin = clock_type::now();
+		for (const auto &side : sides)
+		{
+			if (side.error)
+				std::rethrow_exception(side.error);
+			std::cout << side.listing;
+		}
+		auto output = seconds_since(begin);
+
+		auto first = sides[0].doc ? &*sides[0].doc : nullptr;
+		auto &second = *sides[1].doc;
+
+		begin = clock_type::now();
+		auto report = PDF::DiffReport();
+		if (golden)
+			second.diff(report, *golden);
+		else
+			first->diff(report, second);
+		auto diff = seconds_since(begin);
+
+		begin = clock_type::now();
+		writer->Write(report);
+		output += seconds_since(begin);
+
+		if (first && cache && files[0] != "-")
+			cache->Store(std::string(files[0]), first->GetFingerprint());
+
+		if (stats)
+		{
+			if (first)
+				print_statistics(files[0], *first);
+			print_statistics(files[1], second);
+			std::cerr << "deep copies: " << PDF::Array::GetCopies() << " arrays, " << PDF::Dictionary::GetCopies() << " dictionaries" << std::endl;
+		}
 
-		first.diff(std::cout, second);
+		if (timing)
+		{
+			std::cout.flush();
+			std::cerr << std::fixed << std::setprecision(3);
+			for (const auto &side : sides)
+				std::cerr << side.name << ": load " << side.load << " s, listing " << side.list << " s" << std::endl;
+			std::cerr << "load and listing (concurrent): " << load << " s" << std::endl
+					  << "output: " << output << " s" << std::endl
+					  << "diff: " << diff << " s (" << PDF::CompareBytesKernel() << " byte compare)" << std::endl;
+			if (options.operators)
+			{
+				auto operators = first->GetStatistics().operators + second.GetStatistics().operators;
+				std::cerr << "operators: " << operators << " (" << std::setprecision(0) << (diff > 0 ? operators / diff : 0) << " per second)" << std::setprecision(3) << std::endl;
+			}
+			std::cerr << "total: " << seconds_since(total) << " s" << std::endl;
+		}
 	}
 	catch (const std::exception &e)
 	{
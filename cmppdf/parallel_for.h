@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Call func(i) for every i in [0, count) on up to `jobs` threads.
+ *
+ * Every worker starts on its own contiguous slice and takes small grains from
+ * the front of it. A worker that runs dry steals the back half of another
+ * slice. The first exception thrown by a worker is rethrown once all workers
+ * have joined.
+ */
+template <typename Function>
+void parallel_for(size_t count, size_t jobs, Function func)
+{
+	if (jobs > count)
+		jobs = count;
+	if (jobs <= 1)
+	{
+		for (auto i = size_t(0); i < count; ++i)
+			func(i);
+		return;
+	}
+
+	struct Slice
+	{
+		std::mutex lock;
+		size_t begin = 0;
+		size_t end = 0;
+	};
+
+	const auto grain = size_t(16);
+	auto slices = std::vector<Slice>(jobs);
+	for (auto w = size_t(0); w < jobs; ++w)
+	{
+		slices[w].begin = count * w / jobs;
+		slices[w].end = count * (w + 1) / jobs;
+	}
+
+	auto failed = std::atomic<bool>(false);
+	auto error = std::exception_ptr();
+	auto error_lock = std::mutex();
+
+	auto take = [&](size_t w, size_t &begin, size_t &end) {
+		auto &own = slices[w];
+		{
+			auto lock = std::lock_guard<std::mutex>(own.lock);
+			if (own.begin < own.end)
+			{
+				begin = own.begin;
+				end = std::min(begin + grain, own.end);
+				own.begin = end;
+				return true;
+			}
+		}
+
+		// Steal the back half of the next slice that still has work.
+		for (auto k = size_t(1); k < jobs; ++k)
+		{
+			auto &victim = slices[(w + k) % jobs];
+			auto lock = std::lock_guard<std::mutex>(victim.lock);
+			auto remain = victim.end - victim.begin;
+			if (!remain)
+				continue;
+			begin = victim.begin + remain / 2;
+			end = victim.end;
+			victim.end = begin;
+			break;
+		}
+		if (begin == end)
+			return false;
+
+		// Keep the stolen work in the own slice so that others can steal it back.
+		auto lock = std::lock_guard<std::mutex>(own.lock);
+		own.begin = std::min(begin + grain, end);
+		own.end = end;
+		end = own.begin;
+		return true;
+	};
+
+	auto worker = [&](size_t w) {
+		try
+		{
+			for (;;)
+			{
+				auto begin = size_t(0);
+				auto end = size_t(0);
+				if (failed || !take(w, begin, end))
+					break;
+				for (auto i = begin; i < end; ++i)
+					func(i);
+			}
+		}
+		catch (...)
+		{
+			auto lock = std::lock_guard<std::mutex>(error_lock);
+			if (!error)
+				error = std::current_exception();
+			failed = true;
+		}
+	};
+
+	auto threads = std::vector<std::thread>();
+	for (auto w = size_t(1); w < jobs; ++w)
+		threads.emplace_back(worker, w);
+	worker(0);
+	for (auto &thread : threads)
+		thread.join();
+
+	if (error)
+		std::rethrow_exception(error);
+}
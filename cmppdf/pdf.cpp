@@ -1,6 +1,11 @@
 #include "pdf.h"
+#include "pdf_filter.h"
+#include "pdf_printer.h"
+#include "parallel_for.h"
+#include <algorithm>
+#include <numeric>
 #include <sstream>
-#include <regex>
+#include <charconv>
 
 using namespace PDF;
 
@@ -10,63 +15,753 @@ using namespace PDF;
 
 inline bool is_hex(char ch) { return ch >= '0' && ch <= '9' || ch >= 'A' && ch <= 'F' || ch >= 'a' && ch <= 'f'; }
 inline bool is_whitespace(char ch) { return !ch || ch == '\f' || ch == '\t' || ch == '\r' || ch == '\n' || ch == ' '; }
+inline bool is_delimiter(char ch) { return std::string_view(DELIMITER).find_first_of(ch) != std::string_view::npos; }
 
-Document::Document(std::string_view name)
-	: FileImage(name)
+/**
+ * Consume an unsigned decimal number from the head of the view.
+ */
+static bool parse_unsigned(std::string_view &s, size_t &value)
+{
+	auto r = std::from_chars(s.data(), s.data() + s.size(), value);
+	if (r.ec != std::errc() || r.ptr == s.data())
+		return false;
+	s.remove_prefix(r.ptr - s.data());
+	return true;
+}
+
+/**
+ * Fixed-width cross-reference entry: nnnnnnnnnn ggggg n EOL (20 bytes)
+ */
+static bool decode_xref_row(std::string_view row, Revision::Entry &entry)
 {
+	if (row.size() < 18 || row[10] != ' ' || row[16] != ' ' || (row[17] != 'n' && row[17] != 'f'))
+		return false;
+	auto offset = size_t(0);
+	auto revision = size_t(0);
+	for (auto i = 0; i < 10; ++i)
+	{
+		if (row[i] < '0' || row[i] > '9')
+			return false;
+		offset = offset * 10 + (row[i] - '0');
+	}
+	for (auto i = 11; i < 16; ++i)
+	{
+		if (row[i] < '0' || row[i] > '9')
+			return false;
+		revision = revision * 10 + (row[i] - '0');
+	}
+	entry.offset = long(offset);
+	entry.revision = int(revision);
+	entry.used = row[17] == 'n';
+	return true;
+}
+
+static Xref xref_of(const Revision::Entry &entry)
+{
+	auto xref = Xref();
+	xref.offset = entry.offset;
+	xref.revision = entry.revision;
+	xref.used = entry.used;
+	xref.container = entry.container;
+	xref.index = entry.index;
+	return xref;
+}
+
+/**
+ * Decoded content of a page. An array of streams is treated as their concatenation.
+ */
+static decoded_t decode_contents(const std::vector<const Xref *> &streams, const resolver_t &resolve)
+{
+	auto content = decoded_t();
+	for (auto xref : streams)
+	{
+		auto data = Decode(xref->object, xref->stream, false, resolve);
+		content.insert(content.end(), data.begin(), data.end());
+		// Streams may only be split between tokens; keep the last and first token apart.
+		content.push_back('\n');
+	}
+	return content;
+}
+
+/**
+ * PDF numbers are [+-]digits[.digits] without exponent.
+ */
+static double parse_numeric(std::string_view token)
+{
+	if (!token.empty() && token[0] == '+')
+		token.remove_prefix(1);
+	auto value = 0.0;
+	auto r = std::from_chars(token.data(), token.data() + token.size(), value);
+	if (r.ec != std::errc())
+		throw parse_error("Failed parse numeric.");
+	return value;
+}
+
+Document::Document(std::string_view name, const Options &options)
+	: FileImage(name), m_Options(options)
+{
+	auto scope = Arena::Scope(m_Arena);
 	if (!Analyze())
 		throw parse_error("Not PDF");
 }
 
+/**
+ * Cheapest checks first, and false at the first difference: objects are only
+ * loaded up to the first one that differs. Identical files need no objects.
+ */
 bool Document::operator==(const Document &r) const
 {
+	if (Size() == r.Size() && CompareBytes(Data(), r.Data(), Size()).Equal())
+		return true;
+
 	if (m_Version != r.m_Version)
 		return false;
 
-	if (m_XrefTable.size() != r.m_XrefTable.size())
+	// File Trailer
+	if (m_FileTrailer.size != r.m_FileTrailer.size)
 		return false;
 
+	// Shape of the xref table, known without loading anything.
+	if (m_XrefTable.size() != r.m_XrefTable.size())
+		return false;
 	auto table_size = m_XrefTable.size();
 	for (auto i = decltype(table_size)(0); i < table_size; ++i)
-		if (m_XrefTable[i] != r.m_XrefTable[i])
+		if (m_XrefTable[i].used != r.m_XrefTable[i].used || m_XrefTable[i].revision != r.m_XrefTable[i].revision)
 			return false;
 
-	// File Trailer
-	if (m_FileTrailer.size != r.m_FileTrailer.size)
-		return false;
+	// Parsed with the cross-reference sections.
 	if (m_FileTrailer.root != r.m_FileTrailer.root)
 		return false;
 	if (m_FileTrailer.info != r.m_FileTrailer.info)
 		return false;
 
+	auto lresolve = Resolver();
+	auto rresolve = r.Resolver();
+	for (auto i = decltype(table_size)(0); i < table_size; ++i)
+		if (!GetXref(i).Equal(r.GetXref(i), m_Options.decoded, lresolve, rresolve))
+			return false;
+
+	return true;
+}
+
+Fingerprint Document::GetFingerprint() const
+{
+	auto fp = Fingerprint();
+	fp.file_size = Size();
+	fp.file_hash = Hash(Data(), Size());
+	fp.decoded = m_Options.decoded;
+	fp.version = m_Version;
+	fp.trailer_size = m_FileTrailer.size;
+	fp.root = m_FileTrailer.root.Hash();
+	fp.info = m_FileTrailer.info.Hash();
+	fp.objects.resize(m_XrefTable.size());
+	auto resolve = Resolver();
+	for (auto i = size_t(0); i < fp.objects.size(); ++i)
+		fp.objects[i] = GetEntryHash(i, m_Options.decoded, resolve);
+	return fp;
+}
+
+/**
+ * Cheapest checks first, in the order of operator==; the entry hashes are
+ * computed as the golden side recorded them, with or without --decoded.
+ */
+bool Document::Matches(const Fingerprint &golden) const
+{
+	if (golden.version != m_Version || golden.trailer_size != m_FileTrailer.size)
+		return false;
+	if (golden.objects.size() != m_XrefTable.size())
+		return false;
+	if (golden.root != m_FileTrailer.root.Hash() || golden.info != m_FileTrailer.info.Hash())
+		return false;
+
+	auto resolve = Resolver();
+	for (auto i = size_t(0); i < golden.objects.size(); ++i)
+		if (golden.objects[i] != GetEntryHash(i, golden.decoded, resolve))
+			return false;
 	return true;
 }
 
-void Document::diff(std::ostream &out, const Document &r) const
+void Document::diff(DiffReport &report, const Fingerprint &golden) const
+{
+	if (golden.version != m_Version)
+		report.Changed(0, "Version", std::string_view(golden.version), m_Version);
+
+	if (golden.objects.size() != m_XrefTable.size())
+		report.Changed(0, "Xref table size", golden.objects.size(), m_XrefTable.size());
+	else
+	{
+		auto resolve = Resolver();
+		for (auto i = size_t(0); i < golden.objects.size(); ++i)
+			if (golden.objects[i] != GetEntryHash(i, golden.decoded, resolve))
+				report.Add(DiffRecord::Kind::Note, 0, "Xref table [" + std::to_string(i) + "]", "changed");
+	}
+
+	if (golden.trailer_size != m_FileTrailer.size)
+		report.Changed(0, "File trailer size", golden.trailer_size, m_FileTrailer.size);
+}
+
+hash_t Document::GetEntryHash(size_t obj_no, bool decoded, const resolver_t &resolve) const
+{
+	const auto &xref = GetXref(obj_no);
+	return decoded ? xref.DecodedHash(resolve) : xref.Hash();
+}
+
+void Document::diff(DiffReport &report, const Document &r) const
 {
 	if (m_Version != r.m_Version)
-		out << "Version: " << m_Version << " / " << r.m_Version << std::endl;
+		report.Changed(0, "Version", m_Version, r.m_Version);
+
+	if (m_Options.page != Options::all_pages)
+	{
+		DiffPage(report, r, m_Options.page);
+		return;
+	}
+
+	if (m_Options.semantic)
+	{
+		DiffSemantic(report, r);
+		return;
+	}
 
 	if (m_XrefTable.size() != r.m_XrefTable.size())
-		out << "Xref table size: " << m_XrefTable.size() << " / " << r.m_XrefTable.size() << std::endl;
+		report.Changed(0, "Xref table size", m_XrefTable.size(), r.m_XrefTable.size());
 	else
 	{
 		auto table_size = m_XrefTable.size();
+		auto lresolve = Resolver();
+		auto rresolve = r.Resolver();
 		for (auto i = decltype(table_size)(0); i < table_size; ++i)
 		{
-			auto &lo = m_XrefTable[i];
-			auto &ro = r.m_XrefTable[i];
-			if (lo != ro)
+			auto &lo = GetXref(i);
+			auto &ro = r.GetXref(i);
+			if (!lo.Equal(ro, m_Options.decoded, lresolve, rresolve))
 			{
-				out << "Xref table [" << i << "]" << std::endl;
-				lo.diff(out, ro, 1);
+				report.Add(DiffRecord::Kind::Section, 0, "Xref table [" + std::to_string(i) + "]");
+				lo.diff(report, ro, 1, m_Options.decoded, lresolve, rresolve);
 			}
 		}
 	}
 
 	// File Trailer
 	if (m_FileTrailer.size != r.m_FileTrailer.size)
-		out << "File trailer size: " << m_FileTrailer.size << " / " << r.m_FileTrailer.size << std::endl;
+		report.Changed(0, "File trailer size", m_FileTrailer.size, r.m_FileTrailer.size);
+
+	if (m_Options.operators)
+		DiffPages(report, r);
+}
+
+/**
+ * 3.4.5 Incremental Updates
+ */
+void Document::DiffRevisions(DiffReport &report, size_t count) const
+{
+	auto total = m_Revisions.size();
+	auto first = total - std::min(count, total);
+	report.Add(DiffRecord::Kind::Note, 0, "Revisions", std::to_string(total));
+
+	auto touched = std::vector<bool>(m_XrefTable.size());
+	auto objects = std::vector<indirect_t>();
+	for (auto k = first; k < total; ++k)
+	{
+		const auto &revision = m_Revisions[k];
+		report.Add(DiffRecord::Kind::Note, 0, "Revision [" + std::to_string(k) + "]", std::to_string(revision.entries.size()) + " entries at " + std::to_string(revision.offset));
+		for (const auto &entry : revision.entries)
+			if (!touched[entry.obj_no])
+			{
+				touched[entry.obj_no] = true;
+				objects.push_back(entry.obj_no);
+			}
+	}
+	std::sort(objects.begin(), objects.end());
+
+	// The state before: the newest older section that defines the object.
+	// Untouched objects are kept too, as containers of compressed ones.
+	auto before = std::vector<const Revision::Entry *>(m_XrefTable.size());
+	for (auto k = size_t(0); k < first; ++k)
+		for (const auto &entry : m_Revisions[k].entries)
+			before[entry.obj_no] = &entry;
+
+	// Object streams as they were before, for containers that a later
+	// revision redefined; the current ones would yield the new objects.
+	auto containers = std::map<indirect_t, ObjectStream>();
+	auto container_of = [&](indirect_t obj_no) -> const ObjectStream * {
+		if (obj_no >= touched.size() || !touched[obj_no])
+			return &GetObjectStream(obj_no);
+		auto it = containers.find(obj_no);
+		if (it != containers.end())
+			return &it->second;
+		if (!before[obj_no] || !before[obj_no]->used || before[obj_no]->container)
+			return nullptr;
+		auto xref = xref_of(*before[obj_no]);
+		LoadObject(xref, true);
+		return &containers.emplace(obj_no, ReadObjectStream(xref)).first->second;
+	};
+
+	auto resolve = Resolver();
+	for (auto obj_no : objects)
+	{
+		const auto &now = GetXref(obj_no);
+		if (!before[obj_no])
+		{
+			report.Add(DiffRecord::Kind::Note, 0, "Xref table [" + std::to_string(obj_no) + "]", "No entry before revision [" + std::to_string(first) + "].");
+			continue;
+		}
+
+		auto old = xref_of(*before[obj_no]);
+		if (old.used && old.container)
+		{
+			auto stm = container_of(old.container);
+			if (!stm)
+			{
+				report.Add(DiffRecord::Kind::Note, 0, "Xref table [" + std::to_string(obj_no) + "]", "No object stream " + std::to_string(old.container) + " before revision [" + std::to_string(first) + "].");
+				continue;
+			}
+			LoadObject(old, *stm);
+		}
+		else if (old.used)
+			LoadObject(old, true);
+		if (!old.Equal(now, m_Options.decoded, resolve, resolve))
+		{
+			report.Add(DiffRecord::Kind::Section, 0, "Xref table [" + std::to_string(obj_no) + "]");
+			old.diff(report, now, 1, m_Options.decoded, resolve, resolve);
+		}
+	}
+}
+
+/**
+ * Operator diff of the content of each pair of pages; empty reports for
+ * pairs that are the same.
+ */
+std::vector<Document::ContentReport> Document::DiffContents(const Document &r, const std::vector<std::pair<indirect_t, indirect_t>> &pages) const
+{
+	// Objects load lazily and not thread-safe, so the streams are resolved up
+	// front; decoding and comparing then runs on `jobs` threads.
+	auto reports = std::vector<ContentReport>(pages.size());
+	auto streams = std::vector<std::pair<std::vector<const Xref *>, std::vector<const Xref *>>>(pages.size());
+	for (auto i = size_t(0); i < pages.size(); ++i)
+	{
+		try
+		{
+			streams[i].first = GetContentStreams(GetObject(pages[i].first).object.GetDictionary());
+			streams[i].second = r.GetContentStreams(r.GetObject(pages[i].second).object.GetDictionary());
+		}
+		catch (const std::exception &e)
+		{
+			reports[i].error = e.what();
+		}
+	}
+
+	parallel_for(pages.size(), m_Options.jobs, [&](size_t i) {
+		const auto &left = streams[i].first;
+		const auto &right = streams[i].second;
+		if (!reports[i].error.empty())
+			return;
+		try
+		{
+			// Pages whose content is identical need no tokens: first the raw
+			// streams, then the decoded bytes.
+			auto same = [](const Xref *l, const Xref *r) { return l->object == r->object && l->stream == r->stream; };
+			if (std::equal(left.begin(), left.end(), right.begin(), right.end(), same))
+				return;
+			auto lcontent = decode_contents(left, Resolver());
+			auto rcontent = decode_contents(right, r.Resolver());
+			if (lcontent.size() == rcontent.size() && CompareBytes(lcontent.data(), rcontent.data(), lcontent.size()).Equal())
+				return;
+			auto lops = Tokenize(std::string_view(lcontent.data(), lcontent.size()));
+			auto rops = Tokenize(std::string_view(rcontent.data(), rcontent.size()));
+			m_Statistics.operators += lops.size();
+			r.m_Statistics.operators += rops.size();
+
+			auto &report = reports[i].report;
+			auto text = std::ostringstream();
+			auto operation = [&text](const Operation &op) {
+				text.str(std::string());
+				text << op;
+				return text.str();
+			};
+			DiffOperations(lops, rops, [&](const OperationRange &range) {
+				report.Add(DiffRecord::Kind::Range, 1, "Operators",
+						   std::to_string(range.left) + ", " + std::to_string(range.left + range.left_size),
+						   std::to_string(range.right) + ", " + std::to_string(range.right + range.right_size));
+				for (auto k = range.left; k < range.left + range.left_size; ++k)
+					report.Add(DiffRecord::Kind::Removed, 2, {}, operation(lops[k]));
+				for (auto k = range.right; k < range.right + range.right_size; ++k)
+					report.Add(DiffRecord::Kind::Inserted, 2, {}, {}, operation(rops[k]));
+			});
+		}
+		catch (const std::exception &e)
+		{
+			reports[i].error = e.what();
+		}
+	});
+	return reports;
+}
+
+/**
+ * Pages are paired by their position in the page tree.
+ */
+void Document::DiffPages(DiffReport &report, const Document &r) const
+{
+	const auto &lpages = GetPageIndex();
+	const auto &rpages = r.GetPageIndex();
+	if (lpages.size() != rpages.size())
+		report.Changed(0, "Page count", lpages.size(), rpages.size());
+
+	auto pairs = std::vector<std::pair<indirect_t, indirect_t>>();
+	for (auto i = size_t(0); i < std::min(lpages.size(), rpages.size()); ++i)
+		pairs.emplace_back(lpages[i].obj_no, rpages[i].obj_no);
+
+	auto reports = DiffContents(r, pairs);
+	for (auto i = size_t(0); i < reports.size(); ++i)
+		if (!reports[i].error.empty())
+			report.Add(DiffRecord::Kind::Note, 0, "Page [" + std::to_string(i) + "]", reports[i].error);
+		else if (!reports[i].report.empty())
+		{
+			report.Add(DiffRecord::Kind::Section, 0, "Page [" + std::to_string(i) + "]");
+			report.Append(reports[i].report);
+		}
+}
+
+/******************************************************************************
+
+******************************************************************************/
+
+/**
+ * Hash of an object in which every reference stands for the label of its
+ * target instead of its object number. /Parent is left out: it points back
+ * up the tree, and would make every page depend on all of its siblings.
+ */
+static hash_t graph_hash(const Object &obj, const std::vector<hash_t> &labels, std::initializer_list<name_t> ignored = {})
+{
+	switch (obj.GetType())
+	{
+	case Object::Type::INDIRECT:
+	{
+		auto ref = obj.GetIndirect();
+		return HashCombine(hash_t(Object::Type::INDIRECT), ref < labels.size() ? labels[ref] : 0);
+	}
+
+	case Object::Type::ARRAY:
+	{
+		const auto &array = obj.GetArray();
+		auto h = HashCombine(hash_t(Object::Type::ARRAY), array.size());
+		for (const auto &item : array)
+			h = HashCombine(h, graph_hash(item, labels));
+		return h;
+	}
+
+	case Object::Type::DICTIONARY:
+	{
+		// Summed like Dictionary::Hash, so the order of the keys does not matter.
+		auto sum = hash_t(0);
+		auto count = size_t(0);
+		for (const auto &item : obj.GetDictionary())
+		{
+			if (item.first == Name::Parent || std::find(ignored.begin(), ignored.end(), item.first) != ignored.end())
+				continue;
+			sum += HashCombine(item.first.Hash(), graph_hash(item.second, labels));
+			++count;
+		}
+		return HashCombine(HashCombine(hash_t(Object::Type::DICTIONARY), count), sum);
+	}
+
+	default:
+		return obj.Hash();
+	}
+}
+
+/**
+ * Labels of every object in the document.
+ */
+std::vector<hash_t> Document::GetGraphHashes() const
+{
+	// Page > Resources > Font > FontDescriptor > FontFile
+	const auto rounds = 5;
+
+	auto objects = std::vector<indirect_t>(m_XrefTable.size());
+	std::iota(objects.begin(), objects.end(), indirect_t(0));
+	return GetGraphHashes(objects, rounds);
+}
+
+/**
+ * A label per object that does not depend on object numbers. Every round
+ * replaces the references of an object by the labels of their targets from
+ * the round before (Weisfeiler-Lehman refinement), so after n rounds a label
+ * covers everything up to n references away. The work is linear in the
+ * number of `objects` per round; objects not listed are labelled 0.
+ */
+std::vector<hash_t> Document::GetGraphHashes(const std::vector<indirect_t> &objects, int rounds) const
+{
+	auto size = m_XrefTable.size();
+	auto streams = std::vector<hash_t>(size);
+	for (auto i : objects)
+	{
+		try
+		{
+			const auto &xref = GetObject(i);
+			if (!xref.used)
+				continue;
+			if (m_Options.decoded && xref.object == Object::Type::DICTIONARY && xref.object.HasKey(Name::Length))
+			{
+				auto data = Decode(xref.object, xref.stream, true, Resolver());
+				streams[i] = PDF::Hash(data.data(), data.size());
+			}
+			else
+				streams[i] = xref.stream.Hash();
+		}
+		catch (const std::exception &)
+		{
+			// A broken object is labelled by its raw bytes alone.
+			streams[i] = m_XrefTable[i].stream.Hash();
+		}
+	}
+
+	auto labels = std::vector<hash_t>(size);
+	auto next = std::vector<hash_t>(size);
+	for (auto round = 0; round < rounds; ++round)
+	{
+		for (auto i : objects)
+		{
+			const auto &xref = m_XrefTable[i];
+			if (!xref.used || !xref.loaded)
+				continue;
+			auto encoded = m_Options.decoded && streams[i] && xref.object == Object::Type::DICTIONARY;
+			next[i] = HashCombine(graph_hash(xref.object, labels, encoded ? EncodingKeys : std::initializer_list<name_t>()), streams[i]);
+		}
+		labels.swap(next);
+	}
+	return labels;
+}
+
+/**
+ * Entries of two dictionaries whose labels differ, by key text.
+ */
+static void diff_entries(DiffReport &report, size_t depth, const Object &l, const std::vector<hash_t> &ll, const Object &r, const std::vector<hash_t> &rl, std::initializer_list<name_t> ignored)
+{
+	auto empty = dictionary_t();
+	auto ls = (l == Object::Type::DICTIONARY ? l.GetDictionary() : empty).Sorted();
+	auto rs = (r == Object::Type::DICTIONARY ? r.GetDictionary() : empty).Sorted();
+	auto skip = [&](name_t key) { return key == Name::Parent || std::find(ignored.begin(), ignored.end(), key) != ignored.end(); };
+
+	auto li = ls.begin();
+	auto ri = rs.begin();
+	while (li != ls.end() || ri != rs.end())
+	{
+		auto order = li == ls.end() ? 1 : ri == rs.end() ? -1 : (*li)->first.View().compare((*ri)->first.View());
+		auto key = order <= 0 ? (*li)->first : (*ri)->first;
+		if (skip(key))
+			;
+		else if (order < 0)
+			report.Add(DiffRecord::Kind::Note, depth, key.View(), "No key in the right dictionary.");
+		else if (order > 0)
+			report.Add(DiffRecord::Kind::Note, depth, key.View(), "No key in the left dictionary.");
+		else if (graph_hash((*li)->second, ll) != graph_hash((*ri)->second, rl))
+			report.Add(DiffRecord::Kind::Note, depth, key.View(), "changed");
+		if (order <= 0)
+			++li;
+		if (order >= 0)
+			++ri;
+	}
+}
+
+/**
+ * Pages are matched by their labels with a shortest edit script, so that
+ * renumbered objects, and inserted, removed or moved pages, only show where
+ * something really changed.
+ */
+void Document::DiffSemantic(DiffReport &report, const Document &r) const
+{
+	auto llabels = GetGraphHashes();
+	auto rlabels = r.GetGraphHashes();
+
+	// The page tree is compared page by page below.
+	auto catalog = DiffReport();
+	diff_entries(catalog, 1, m_FileTrailer.root, llabels, r.m_FileTrailer.root, rlabels, {Name::Pages});
+	if (!catalog.empty())
+	{
+		report.Add(DiffRecord::Kind::Group, 0, "Catalog");
+		report.Append(catalog);
+	}
+	auto info = DiffReport();
+	diff_entries(info, 1, m_FileTrailer.info, llabels, r.m_FileTrailer.info, rlabels, {});
+	if (!info.empty())
+	{
+		report.Add(DiffRecord::Kind::Group, 0, "Info");
+		report.Append(info);
+	}
+
+	const auto &lpages = GetPageIndex();
+	const auto &rpages = r.GetPageIndex();
+	if (lpages.size() != rpages.size())
+		report.Changed(0, "Page count", lpages.size(), rpages.size());
+
+	auto page_labels = [](const std::vector<Page> &pages, const std::vector<hash_t> &labels) {
+		auto list = std::vector<hash_t>(pages.size());
+		for (auto i = size_t(0); i < pages.size(); ++i)
+			list[i] = labels[pages[i].obj_no];
+		return list;
+	};
+	auto lh = page_labels(lpages, llabels);
+	auto rh = page_labels(rpages, rlabels);
+
+	// Pages replaced one for one are compared; the rest were added or removed.
+	struct Change
+	{
+		size_t left = SIZE_MAX;
+		size_t right = SIZE_MAX;
+	};
+	auto changes = std::vector<Change>();
+	auto pairs = std::vector<std::pair<indirect_t, indirect_t>>();
+	DiffSequences(lh.data(), lh.size(), rh.data(), rh.size(), [&](const EditRange &range) {
+		auto common = std::min(range.left_size, range.right_size);
+		for (auto k = size_t(0); k < std::max(range.left_size, range.right_size); ++k)
+		{
+			auto change = Change();
+			if (k < range.left_size)
+				change.left = range.left + k;
+			if (k < range.right_size)
+				change.right = range.right + k;
+			changes.push_back(change);
+			if (k < common)
+				pairs.emplace_back(lpages[change.left].obj_no, rpages[change.right].obj_no);
+		}
+	});
+
+	auto reports = m_Options.operators ? DiffContents(r, pairs) : std::vector<ContentReport>();
+	auto pair = size_t(0);
+	for (const auto &change : changes)
+	{
+		if (change.right == SIZE_MAX)
+		{
+			report.Add(DiffRecord::Kind::Note, 0, "Page [" + std::to_string(change.left) + "] / [-]", "No page in the right document.");
+			continue;
+		}
+		if (change.left == SIZE_MAX)
+		{
+			report.Add(DiffRecord::Kind::Note, 0, "Page [-] / [" + std::to_string(change.right) + "]", "No page in the left document.");
+			continue;
+		}
+
+		report.Add(DiffRecord::Kind::Section, 0, "Page [" + std::to_string(change.left) + "] / [" + std::to_string(change.right) + "]");
+		diff_entries(report, 1, GetObject(lpages[change.left].obj_no).object, llabels, r.GetObject(rpages[change.right].obj_no).object, rlabels, {});
+		if (pair < reports.size())
+		{
+			const auto &contents = reports[pair];
+			if (!contents.error.empty())
+				report.Add(DiffRecord::Kind::Note, 1, "Contents", contents.error);
+			else
+				report.Append(contents.report);
+		}
+		++pair;
+	}
+}
+
+/**
+ * Indirect references in `obj`, except through /Parent.
+ */
+static void collect_references(const Object &obj, std::vector<indirect_t> &refs)
+{
+	switch (obj.GetType())
+	{
+	case Object::Type::INDIRECT:
+		refs.push_back(obj.GetIndirect());
+		break;
+
+	case Object::Type::ARRAY:
+		for (const auto &item : obj.GetArray())
+			collect_references(item, refs);
+		break;
+
+	case Object::Type::DICTIONARY:
+		for (const auto &item : obj.GetDictionary())
+			if (item.first != Name::Parent)
+				collect_references(item.second, refs);
+		break;
+
+	default:
+		break;
+	}
+}
+
+/**
+ * `obj_no` and every object it refers to, directly or not, breadth first;
+ * `depth` is the distance to the farthest one. /Parent is not followed, so
+ * a page does not reach the rest of the page tree.
+ */
+std::vector<indirect_t> Document::GetReachable(indirect_t obj_no, int &depth) const
+{
+	auto seen = std::vector<bool>(m_XrefTable.size());
+	auto objects = std::vector<indirect_t>();
+	auto refs = std::vector<indirect_t>();
+	if (obj_no < seen.size())
+	{
+		seen[obj_no] = true;
+		objects.push_back(obj_no);
+	}
+
+	depth = 0;
+	for (auto begin = size_t(0); begin < objects.size(); ++depth)
+	{
+		auto end = objects.size();
+		for (; begin < end; ++begin)
+		{
+			refs.clear();
+			try
+			{
+				collect_references(GetObject(objects[begin]).object, refs);
+			}
+			catch (const std::exception &)
+			{
+				// A broken object is labelled by its raw bytes and refers to nothing.
+			}
+			for (auto ref : refs)
+				if (ref < seen.size() && !seen[ref])
+				{
+					seen[ref] = true;
+					objects.push_back(ref);
+				}
+		}
+	}
+	return objects;
+}
+
+/**
+ * A single page and what it refers to, compared by labels so that object
+ * numbers may differ between the documents. The rounds cover the farthest
+ * object on either side; nothing else in the documents is loaded.
+ */
+void Document::DiffPage(DiffReport &report, const Document &r, size_t index) const
+{
+	auto lpage = LocatePage(index);
+	auto rpage = r.LocatePage(index);
+	if (!lpage && !rpage)
+		throw std::out_of_range("No page [" + std::to_string(index) + "] in either document.");
+	if (!lpage || !rpage)
+	{
+		report.Add(DiffRecord::Kind::Note, 0, "Page [" + std::to_string(index) + "]", lpage ? "No page in the right document." : "No page in the left document.");
+		return;
+	}
+
+	auto ldepth = 0;
+	auto rdepth = 0;
+	auto lobjects = GetReachable(lpage, ldepth);
+	auto robjects = r.GetReachable(rpage, rdepth);
+	auto rounds = std::max(ldepth, rdepth) + 1;
+	auto llabels = GetGraphHashes(lobjects, rounds);
+	auto rlabels = r.GetGraphHashes(robjects, rounds);
+	if (llabels[lpage] == rlabels[rpage])
+		return;
+
+	report.Add(DiffRecord::Kind::Section, 0, "Page [" + std::to_string(index) + "]");
+	diff_entries(report, 1, GetObject(lpage).object, llabels, r.GetObject(rpage).object, rlabels, {});
+	if (m_Options.operators)
+	{
+		auto contents = DiffContents(r, {{lpage, rpage}}).front();
+		if (!contents.error.empty())
+			report.Add(DiffRecord::Kind::Note, 1, "Contents", contents.error);
+		else
+			report.Append(contents.report);
+	}
 }
 
 bool Document::Analyze()
@@ -94,7 +789,9 @@ bool Document::Analyze()
 	if (line.empty())
 		return false;
 
-	auto xref_offset = strtoul(line.data(), NULL, 10);
+	auto xref_offset = size_t(0);
+	if (!parse_unsigned(line, xref_offset))
+		return false;
 
 	// Begin tag of Cross-reference table
 	line = GetLineBack();
@@ -102,21 +799,31 @@ bool Document::Analyze()
 		return false;
 
 	// Parsing Cross-reference table
-	Seek(xref_offset);
 	m_XrefTable.clear();
+	ParseRevisions(xref_offset);
 
-	ParseXrefTable();
-
-	// Pre-decode objects.
-	for (auto &xref : m_XrefTable)
-		GetObject(xref);
+	// Pre-decode objects; otherwise they are parsed when first touched.
+	if (m_Options.jobs > 1)
+		PreDecodeParallel();
+	else if (m_Options.eager)
+		PreDecode();
 
-	// Recursively traversing objects.
-	// ParseCatalog(m_FileTrailer.root);
+	// Later comparisons jump between objects and streams.
+	Advise(Access::Random);
 
 	return true;
 }
 
+/**
+ * 3.6 Document Structure
+ */
+void Document::Traverse(DiffReport &report) const
+{
+	auto scope = Arena::Scope(m_Arena);
+	auto traversal = Traversal{report, std::vector<bool>(m_XrefTable.size())};
+	ParseCatalog(traversal, m_FileTrailer.root.GetDictionary());
+}
+
 /******************************************************************************
 
 ******************************************************************************/
@@ -124,123 +831,526 @@ bool Document::Analyze()
 /**
  * TABLE 3.25 Entries in the catalog dictionary
  */
-void Document::ParseCatalog(dictionary_t &dic)
+void Document::ParseCatalog(Traversal &t, const dictionary_t &dic) const
 {
-	if (dic["Type"] != "Catalog")
+	if (dic[Name::Type] != Name::Catalog)
 		throw parse_error("not Catalog");
 
-	std::cout << "Catalog: " << dic.Display() << std::endl;
+	t.report.Add(DiffRecord::Kind::Note, 0, "Catalog", dic.Display());
 
 	// Optional; PDF 1.4
 	// dic["Version"] // Name
 
-	if (dic.HasKey("Outlines"))
-		ParseOutlines(GetIndirectObject(dic["Outlines"]));
-	if (dic.HasKey("Metadata"))
-		ParseMetadata(GetIndirectObject(dic["Metadata"]));
-	ParsePages(GetIndirectObject(dic["Pages"]));
+	if (dic.HasKey(Name::Outlines))
+		ParseOutlines(t, GetIndirectObject(dic[Name::Outlines]).GetDictionary());
+	if (dic.HasKey(Name::Metadata))
+		ParseMetadata(t, GetIndirectObject(dic[Name::Metadata]).GetDictionary());
+	ParsePages(t, GetIndirectObject(dic[Name::Pages]).GetDictionary());
 }
 
 /**
  *
  */
-void Document::ParseOutlines(dictionary_t &dic)
+void Document::ParseOutlines(Traversal &t, const dictionary_t &dic) const
 {
-	if (dic["Type"] != "Outlines")
+	if (dic[Name::Type] != Name::Outlines)
 		throw parse_error("not Outlines");
 
-	std::cout << "Outlines: " << dic.Display() << std::endl;
+	t.report.Add(DiffRecord::Kind::Note, 1, "Outlines", dic.Display());
 }
 
-void Document::ParseMetadata(dictionary_t &dic)
+void Document::ParseMetadata(Traversal &t, const dictionary_t &dic) const
 {
-	if (dic["Type"] != "Metadata")
+	if (dic[Name::Type] != Name::Metadata)
 		throw parse_error("not Metadata");
 
-	std::cout << "Metadata: " << dic.Display() << std::endl;
+	t.report.Add(DiffRecord::Kind::Note, 1, "Metadata", dic.Display());
 }
 
 /**
  * TABLE 3.26 Required entries in a page tree node
  */
-void Document::ParsePages(dictionary_t &dic)
+void Document::ParsePages(Traversal &t, const dictionary_t &dic) const
 {
-	if (dic["Type"] != "Pages")
+	if (dic[Name::Type] != Name::Pages)
 		throw parse_error("not Pages");
 
-	std::cout << "Pages: " << dic.Display() << std::endl;
+	t.report.Add(DiffRecord::Kind::Note, 1, "Pages", dic.Display());
 
-	auto kids = dic["Kids"].GetArray();
-	auto count = dic["Count"].GetNumeric();
-	if (kids.size() != size_t(count))
+	// /Count of the root is the number of leaves of the whole tree.
+	const auto &pages = GetPageIndex();
+	auto count = dic[Name::Count].GetNumeric();
+	if (pages.size() != size_t(count))
 		throw parse_error("failed count of pages");
 
-	for (auto &&page : kids)
-		ParsePage(GetObject(page.GetIndirect()).object.GetDictionary());
+	for (auto i = size_t(0); i < pages.size(); ++i)
+		ParsePage(t, i, pages[i]);
 }
 
 /**
  * TABLE 3.27 Entries in a page object
  */
-void Document::ParsePage(dictionary_t &dic)
+void Document::ParsePage(Traversal &t, size_t index, const Page &page) const
 {
-	if (dic["Type"] != "Page")
+	const auto &dic = GetObject(page.obj_no).object.GetDictionary();
+	if (dic[Name::Type] != Name::Page)
 		throw parse_error("not Page");
 
-	std::cout << "Page: " << dic.Display() << std::endl;
+	t.report.Add(DiffRecord::Kind::Note, 2, "Page [" + std::to_string(index) + "]", dic.Display());
 
-	auto resources = dic["Resources"];
-	if (resources == Object::Type::DICTIONARY)
-		;
-	else if (resources == Object::Type::INDIRECT)
-		resources = GetObject(resources.GetIndirect()).object;
-	ParseResources(resources.GetDictionary());
+	// Pages mostly share one resource dictionary, or inherit it.
+	auto resources = page.resources;
+	if (t.FirstVisit(resources))
+	{
+		if (resources == Object::Type::INDIRECT)
+			resources = GetObject(resources.GetIndirect()).object;
+		if (resources == Object::Type::DICTIONARY)
+			ParseResources(t, resources.GetDictionary());
+	}
 
-	if (dic.HasKey("Contents"))
+	if (dic.HasKey(Name::Contents))
 	{
-		auto contents = dic["Contents"];
-		if (contents == Object::Type::INDIRECT)
-			contents = GetObject(contents.GetIndirect()).object;
-		else if (contents == Object::Type::ARRAY)
-			throw parse_error("unimplement");
+		auto content = decode_contents(GetContentStreams(dic), Resolver());
+		auto operators = Tokenize(std::string_view(content.data(), content.size())).size();
+		t.report.Add(DiffRecord::Kind::Note, 3, "Contents", std::to_string(operators) + " operators");
 	}
 }
 
-void Document::ParseResources(dictionary_t &dic)
+const std::vector<Page> &Document::GetPageIndex() const
 {
-	std::cout << "Resources: " << dic.Display() << std::endl;
+	std::call_once(m_PageIndexBuilt, [this] { BuildPageIndex(); });
+	return m_PageIndex;
+}
 
-	if (dic.HasKey("Font"))
+/**
+ * 3.6.2 Page Tree
+ *
+ * Walks the tree depth first with an explicit stack, so any depth is fine,
+ * and hands the inheritable attributes down to the leaves. A node reached a
+ * second time means a cycle (or a shared subtree, which is just as invalid).
+ */
+void Document::BuildPageIndex() const
+{
+	m_PageIndex.clear();
+	const auto &root = m_FileTrailer.root;
+	if (root != Object::Type::DICTIONARY || !root.HasKey(Name::Pages))
+		return;
+
+	auto visited = std::vector<bool>(m_XrefTable.size());
+	auto stack = std::vector<Page>();
+	auto top = Page();
+	top.obj_no = root[Name::Pages].GetIndirect();
+	stack.push_back(top);
+	while (!stack.empty())
 	{
-		auto font = dic["Font"].GetDictionary();
-		for (const auto &item : font)
+		auto node = stack.back();
+		stack.pop_back();
+
+		if (node.obj_no >= visited.size())
+			throw reference_error("page tree node out of range.");
+		if (visited[node.obj_no])
+			throw parse_error("cycle in page tree.");
+		visited[node.obj_no] = true;
+
+		const auto &dic = GetObject(node.obj_no).object.GetDictionary();
+		auto inherit = [&dic](Object &attribute, name_t key) {
+			if (dic.HasKey(key))
+				attribute = dic[key];
+		};
+		inherit(node.resources, Name::Resources);
+		inherit(node.media_box, Name::MediaBox);
+		inherit(node.crop_box, Name::CropBox);
+		inherit(node.rotate, Name::Rotate);
+
+		if (dic.HasKey(Name::Type) && dic[Name::Type] == Name::Page)
+			m_PageIndex.push_back(node);
+		else if (dic.HasKey(Name::Kids))
 		{
+			// Pushed in reverse, so the first kid is walked first.
+			const auto &kids = dic[Name::Kids].GetArray();
+			for (auto kid = kids.rbegin(); kid != kids.rend(); ++kid)
+			{
+				auto child = node;
+				child.obj_no = kid->GetIndirect();
+				stack.push_back(child);
+			}
+		}
+	}
+}
+
+/**
+ * The streams that make up the /Contents of a page, loaded so that they can
+ * be decoded from any thread.
+ */
+std::vector<const Xref *> Document::GetContentStreams(const dictionary_t &page) const
+{
+	auto streams = std::vector<const Xref *>();
+	if (!page.HasKey(Name::Contents))
+		return streams;
+
+	const auto &contents = page[Name::Contents];
+	const auto &target = contents == Object::Type::INDIRECT ? GetObject(contents.GetIndirect()).object : contents;
+	if (target == Object::Type::ARRAY)
+		for (const auto &ref : target.GetArray())
+			streams.push_back(&GetObject(ref.GetIndirect()));
+	else
+		streams.push_back(&GetObject(contents.GetIndirect()));
+	return streams;
+}
+
+/**
+ * TABLE 3.30 Entries in a resource dictionary
+ *
+ * Fonts and XObjects are shared across pages; each indirect one is handled on
+ * its first reference only, so the work follows the number of distinct
+ * resources rather than the number of pages.
+ */
+void Document::ParseResources(Traversal &t, const dictionary_t &dic) const
+{
+	t.report.Add(DiffRecord::Kind::Note, 3, "Resources", dic.Display());
+
+	auto each = [this, &t, &dic](name_t key, void (Document::*parse)(Traversal &, const dictionary_t &) const) {
+		if (!dic.HasKey(key) || !t.FirstVisit(dic[key]))
+			return;
+		const auto &category = dic[key] == Object::Type::INDIRECT ? GetObject(dic[key].GetIndirect()).object : dic[key];
+		for (const auto &item : category.GetDictionary())
+		{
+			if (!t.FirstVisit(item.second))
+				continue;
 			if (item.second == Object::Type::DICTIONARY)
-				ParseFont(item.second.GetDictionary());
+				(this->*parse)(t, item.second.GetDictionary());
 			else if (item.second == Object::Type::INDIRECT)
-				ParseFont(GetObject(item.second.GetIndirect()).object.GetDictionary());
+				(this->*parse)(t, GetObject(item.second.GetIndirect()).object.GetDictionary());
 		}
-	}
-	if (dic.HasKey("ProcSet"))
+	};
+	each(Name::Font, &Document::ParseFont);
+	each(Name::XObject, &Document::ParseXObject);
+
+	// 10.1 Procedure Sets; obsolete, but still written by most producers.
+	if (dic.HasKey(Name::ProcSet))
 	{
-		auto proc_set = dic["ProcSet"].GetArray();
+		const auto &proc_set = dic[Name::ProcSet] == Object::Type::INDIRECT ? GetObject(dic[Name::ProcSet].GetIndirect()).object : dic[Name::ProcSet];
+		t.report.Add(DiffRecord::Kind::Note, 4, "ProcSet", proc_set.Display());
 	}
 }
 
-void Document::ParseFont(dictionary_t &dic)
+void Document::ParseFont(Traversal &t, const dictionary_t &dic) const
 {
-	if (dic["Type"] != "Font")
+	if (dic[Name::Type] != Name::Font)
 		throw parse_error("not Font");
 
-	std::cout << "Font: " << dic.Display() << std::endl;
+	t.report.Add(DiffRecord::Kind::Note, 4, "Font", dic.Display());
+}
+
+/**
+ * TABLE 4.35 Additional entries specific to a type 1 form dictionary, and
+ * TABLE 4.39 for images; /Type is optional in both.
+ */
+void Document::ParseXObject(Traversal &t, const dictionary_t &dic) const
+{
+	if (dic.HasKey(Name::Type) && dic[Name::Type] != Name::XObject)
+		throw parse_error("not XObject");
+
+	t.report.Add(DiffRecord::Kind::Note, 4, "XObject", dic.Display());
+}
+
+/**
+ * False if `obj` refers to an object this traversal has already handled.
+ * Direct objects are never shared, so they are always new.
+ */
+bool Document::Traversal::FirstVisit(const Object &obj)
+{
+	if (obj != Object::Type::INDIRECT)
+		return true;
+	auto obj_no = obj.GetIndirect();
+	if (obj_no >= visited.size())
+		visited.resize(obj_no + 1);
+	if (visited[obj_no])
+		return false;
+	visited[obj_no] = true;
+	return true;
+}
+
+/******************************************************************************
+
+******************************************************************************/
+
+namespace
+{
+	/**
+	 * Reads the big-endian bit fields of a hint table (F.4).
+	 */
+	class BitReader
+	{
+	public:
+		BitReader(const decoded_t &data) : m_Data(data) {}
+
+		size_t Get(size_t bits)
+		{
+			if (bits > 32 || m_Position + bits > m_Data.size() * 8)
+				throw parse_error("hint table too short.");
+			auto value = size_t(0);
+			for (; bits; --bits, ++m_Position)
+				value = value << 1 | (uint8_t(m_Data[m_Position / 8]) >> (7 - m_Position % 8) & 1);
+			return value;
+		}
+
+		void Skip(size_t bits)
+		{
+			while (bits)
+			{
+				auto step = std::min<size_t>(bits, 32);
+				Get(step);
+				bits -= step;
+			}
+		}
+
+		void Align() { m_Position = (m_Position + 7) / 8 * 8; }
+
+	private:
+		const decoded_t &m_Data;
+		size_t m_Position = 0;
+	};
+}
+
+const Linearization *Document::GetLinearization() const
+{
+	std::call_once(m_LinearizationParsed, [this] { ParseLinearization(); });
+	return m_Linearization ? &*m_Linearization : nullptr;
+}
+
+indirect_t Document::LocatePage(size_t index) const
+{
+	auto is_page = [this](indirect_t obj_no) {
+		const auto &object = GetObject(obj_no).object;
+		return object == Object::Type::DICTIONARY && object.HasKey(Name::Type) && object[Name::Type] == Name::Page;
+	};
+
+	if (const auto *linearization = GetLinearization())
+	{
+		if (index >= linearization->pages)
+			return 0;
+		auto obj_no = indirect_t(0);
+		if (index == 0)
+			obj_no = linearization->first_page;
+		else if (index < linearization->page_offsets.size())
+			obj_no = GetObjectAt(linearization->page_offsets[index]);
+		if (obj_no && obj_no < m_XrefTable.size() && is_page(obj_no))
+			return obj_no;
+	}
+	return index < GetPageCount() ? GetPage(index).obj_no : 0;
+}
+
+/**
+ * The object whose header starts at `offset`, if the cross-reference table
+ * agrees; 0 otherwise.
+ */
+indirect_t Document::GetObjectAt(size_t offset) const
+{
+	if (offset >= Size())
+		return 0;
+
+	auto in = FileImage(*this);
+	in.Seek(offset);
+	auto no = size_t(0);
+	if (!in.GetUnsigned(no) || no >= m_XrefTable.size())
+		return 0;
+	const auto &xref = m_XrefTable[no];
+	return xref.used && !xref.container && size_t(xref.offset) == offset ? indirect_t(no) : 0;
+}
+
+/**
+ * F.2 Linearization Parameter Dictionary
+ *
+ * It must be the first object in the file. Anything unexpected, or a file
+ * that was updated after it was linearized, leaves the file unlinearized.
+ */
+void Document::ParseLinearization() const
+{
+	// Skip the header and the comments after it.
+	auto in = FileImage(*this);
+	in.Seek(0);
+	in.GetLine();
+	for (in.Skip(); in.GetCH() == '%'; in.Skip())
+		in.GetLine();
+
+	auto obj_no = GetObjectAt(in.Tell());
+	if (!obj_no)
+		return;
+
+	try
+	{
+		const auto &dic = GetObject(obj_no).object;
+		if (dic != Object::Type::DICTIONARY || !dic.HasKey(Name::Linearized))
+			return;
+
+		// None of the values can exceed the size of the file.
+		auto number = [this](const Object &value) {
+			if (value != Object::Type::NUMERIC || value.GetNumeric() < 0 || value.GetNumeric() > double(Size()))
+				throw type_error("need a number within the file.");
+			return size_t(value.GetNumeric());
+		};
+		auto linearization = Linearization();
+		linearization.length = number(dic[Name::L]);
+		if (linearization.length != Size())
+			return;
+		const auto &hint = dic[Name::H].GetArray();
+		if (hint.size() < 2)
+			return;
+		linearization.hint_offset = number(hint[0]);
+		linearization.hint_length = number(hint[1]);
+		linearization.first_page = indirect_t(number(dic[Name::O]));
+		linearization.first_page_end = number(dic[Name::E]);
+		linearization.pages = number(dic[Name::N]);
+		linearization.main_xref = number(dic[Name::T]);
+		linearization.page_offsets = ParseHintTable(linearization);
+		m_Linearization = std::move(linearization);
+	}
+	catch (const std::exception &)
+	{
+	}
+}
+
+/**
+ * F.4.1 Page Offset Hint Table
+ *
+ * A header (TABLE F.3) followed by each item of TABLE F.4 for all pages in
+ * turn, every item starting on a byte boundary. Only the page lengths are
+ * needed: page objects come first in their page, so the lengths add up to
+ * the page offsets. Offsets count as if the hint streams were not in the
+ * file.
+ */
+std::vector<size_t> Document::ParseHintTable(const Linearization &linearization) const
+{
+	auto offsets = std::vector<size_t>();
+	try
+	{
+		auto obj_no = GetObjectAt(linearization.hint_offset);
+		if (!obj_no)
+			return offsets;
+		const auto &xref = GetObject(obj_no);
+		auto data = Decode(xref.object, xref.stream, false, Resolver());
+
+		// Items 1 to 5 of the header; the rest does not matter here.
+		auto bits = BitReader(data);
+		bits.Get(32);
+		auto offset = bits.Get(32);
+		auto object_bits = bits.Get(16);
+		auto least_length = bits.Get(32);
+		auto length_bits = bits.Get(16);
+		bits.Skip(32 + 16 + 32 + 16 + 16 + 16 + 16 + 16);
+
+		// Item 1 (objects per page), then item 2 (page lengths).
+		for (auto i = size_t(0); i < linearization.pages; ++i)
+			bits.Get(object_bits);
+		bits.Align();
+		for (auto i = size_t(0); i < linearization.pages; ++i)
+		{
+			offsets.push_back(offset >= linearization.hint_offset ? offset + linearization.hint_length : offset);
+			offset += least_length + bits.Get(length_bits);
+		}
+
+		// Checked here for the first page; the others when they are located.
+		if (offsets.empty() || GetObjectAt(offsets[0]) != linearization.first_page)
+			offsets.clear();
+	}
+	catch (const std::exception &)
+	{
+		offsets.clear();
+	}
+	return offsets;
 }
 
 /******************************************************************************
 
 ******************************************************************************/
 
-void Document::ParseXrefTable()
+/**
+ * 3.4.5 Incremental Updates
+ *
+ * Follows /Prev from the last cross-reference section to the first one, then
+ * overlays the sections oldest first, so that every entry ends up as its
+ * newest revision defines it. /Root and /Info come from the newest trailer
+ * that has them.
+ */
+void Document::ParseRevisions(size_t offset)
+{
+	auto offsets = std::vector<size_t>();
+	auto root = Object();
+	auto info = Object();
+	m_Revisions.clear();
+	for (;;)
+	{
+		if (std::find(offsets.begin(), offsets.end(), offset) != offsets.end())
+			throw parse_error("cycle in /Prev chain.");
+		offsets.push_back(offset);
+
+		auto revision = Revision();
+		revision.offset = offset;
+		Seek(offset);
+		auto trailer = ParseXrefTable(revision);
+
+		// Hybrid-reference files keep their compressed objects in a cross-reference stream; PDF 1.5
+		if (trailer.HasKey(Name::XRefStm))
+		{
+			Seek(size_t(trailer[Name::XRefStm].GetNumeric()));
+			ParseXrefStream(revision);
+		}
+		m_Revisions.push_back(std::move(revision));
+
+		// Optional; must be an indirect reference
+		if (root == Object::Type::NIL && trailer.HasKey(Name::Root))
+			root = trailer[Name::Root];
+		if (info == Object::Type::NIL && trailer.HasKey(Name::Info))
+			info = trailer[Name::Info];
+
+		// Present only if the file has more than one cross-reference section; must not be an indirect reference
+		if (!trailer.HasKey(Name::Prev))
+			break;
+		offset = size_t(trailer[Name::Prev].GetNumeric());
+	}
+	std::reverse(m_Revisions.begin(), m_Revisions.end());
+
+	auto table_size = m_XrefTable.size();
+	for (const auto &revision : m_Revisions)
+		for (const auto &entry : revision.entries)
+			table_size = std::max(table_size, size_t(entry.obj_no) + 1);
+	m_XrefTable.resize(table_size);
+
+	// Nothing is loaded yet, so only the locations are overlaid.
+	for (const auto &revision : m_Revisions)
+		for (const auto &entry : revision.entries)
+		{
+			auto &xref = m_XrefTable[entry.obj_no];
+			xref.offset = entry.offset;
+			xref.revision = entry.revision;
+			xref.used = entry.used;
+			xref.container = entry.container;
+			xref.index = entry.index;
+		}
+
+	// Required if document is encrypted; PDF 1.1
+	// if(trailer.HasKey("Encrypt")){}
+
+	// Optional, but strongly recommended; PDF 1.1
+	// dic.find("ID");
+
+	if (info != Object::Type::NIL)
+		m_FileTrailer.info = GetIndirectObject(info);
+	if (root != Object::Type::NIL)
+		m_FileTrailer.root = GetIndirectObject(root);
+}
+
+/**
+ * One cross-reference section; returns its trailer.
+ */
+Object Document::ParseXrefTable(Revision &revision)
 {
+	// Cross-reference streams (PDF 1.5) begin with an object header instead of the keyword.
+	Skip();
+	if (GetCH() >= '0' && GetCH() <= '9')
+		return ParseXrefStream(revision);
+
 	// Check begin tag
 	auto line = std::string(GetLine());
 	if (line.empty() || line != "xref")
@@ -257,169 +1367,422 @@ void Document::ParseXrefTable()
 			break;
 
 		// Begin number and number of sessions in table: begin_no sessions
-		static auto offset_reg = std::regex(R"(([0-9]+) ([0-9]+))");
-		auto m = std::smatch();
-
-		if (!std::regex_match(line, m, offset_reg))
+		auto header = std::string_view(line);
+		auto begin = size_t(0);
+		auto count = size_t(0);
+		if (!parse_unsigned(header, begin) || header.empty() || header[0] != ' ')
+			continue;
+		header.remove_prefix(1);
+		if (!parse_unsigned(header, count) || !header.empty())
 			continue;
 
-		auto begin = strtoul(m[1].str().c_str(), nullptr, 10);
-		auto count = strtoul(m[2].str().c_str(), nullptr, 10);
-
-		if (begin + count >= m_XrefTable.size())
-			m_XrefTable.resize(begin + count);
-
-		static auto xref_reg = std::regex(R"(^([0-9]{10}) ([0-9]{5}) ([fn])[ \r][\r\n])");
+		revision.entries.reserve(revision.entries.size() + count);
+		if (begin + count > UINT32_MAX)
+			throw reference_error("cross-reference entry out of range.");
 		for (auto i = decltype(count)(0); i < count; ++i)
 		{
-			auto m = GetLine(xref_reg);
-			if (m.size() != 4)
+			auto entry = Revision::Entry();
+			entry.obj_no = indirect_t(begin + i);
+			if (!decode_xref_row(GetLine(20, false), entry))
 				throw std::logic_error("need offset.");
-
-			auto &xref = m_XrefTable[begin + i];
-			xref.offset = strtoul(m[1].str().c_str(), nullptr, 10);
-			xref.revision = strtoul(m[2].str().c_str(), nullptr, 10);
-			xref.used = m[3] == 'n';
+			Seek(Tell() + 18);
+			revision.entries.push_back(entry);
 		}
 	}
 
 	// File Trailer
-	auto trailer = Parse();
+	auto trailer = Parse(*this);
 	if (trailer != Object::Type::DICTIONARY)
 		throw parse_error("Need dictionary");
 
+	// TABLE 3.13 Entries in the file trailer dictionary
 	// Required; must not be an indirect reference
-	auto size = size_t(trailer["Size"].GetNumeric());
+	auto size = size_t(trailer[Name::Size].GetNumeric());
 	if (size > m_FileTrailer.size)
 		m_FileTrailer.size = size;
 
-	// Present only if the file has more than one cross-reference section; must not be an indirect reference
-	if (trailer.HasKey("Prev"))
+	return trailer;
+}
+
+/**
+ * TABLE 3.15 Additional entries specific to a cross-reference stream dictionary
+ */
+Object Document::ParseXrefStream(Revision &revision)
+{
+	// The cross-reference stream is an indirect object that the table being built may not know yet.
+	auto xref = Xref();
+	xref.offset = long(Tell());
+	xref.used = true;
+	GetObject(xref);
+
+	const auto &dic = xref.object;
+	if (dic != Object::Type::DICTIONARY || dic[Name::Type] != Name::XRef)
+		throw parse_error("need xref stream.");
+
+	auto data = Decode(dic, xref.stream);
+
+	// Byte widths of the entry fields: type, field 2, field 3
+	const auto &w = dic[Name::W].GetArray();
+	if (w.size() != 3)
+		throw parse_error("need W array.");
+	size_t width[3];
+	for (auto i = 0; i < 3; ++i)
+		width[i] = size_t(w[i].GetNumeric());
+	auto row = width[0] + width[1] + width[2];
+
+	// Subsections: pairs of begin_no and count; the default is [0 Size]
+	auto size = size_t(dic[Name::Size].GetNumeric());
+	auto subsections = array_t();
+	if (!dic.HasKey(Name::Index))
 	{
-		Seek(size_t(trailer["Prev"].GetNumeric()));
-		ParseXrefTable();
+		subsections.emplace_back(0.0);
+		subsections.emplace_back(double(size));
 	}
+	const auto &index = dic.HasKey(Name::Index) ? dic[Name::Index].GetArray() : subsections;
+	if (size > m_XrefTable.size())
+		m_XrefTable.resize(size);
+	if (size > m_FileTrailer.size)
+		m_FileTrailer.size = size;
 
-	// Required if document is encrypted; PDF 1.1
-	// if(trailer.HasKey("Encrypt")){}
-
-	// Optional; must be an indirect reference
-	if (trailer.HasKey("Info"))
+	auto p = reinterpret_cast<const unsigned char *>(data.data());
+	auto max = p + data.size();
+	for (auto i = size_t(0); i + 1 < index.size(); i += 2)
 	{
-		if (!m_FileTrailer.info.empty())
-			throw parse_error("dupplicated Info item");
-		m_FileTrailer.info = GetIndirectObject(trailer["Info"]);
-	}
+		auto begin = size_t(index[i].GetNumeric());
+		auto count = size_t(index[i + 1].GetNumeric());
+		if (begin + count > UINT32_MAX)
+			throw reference_error("cross-reference entry out of range.");
+		revision.entries.reserve(revision.entries.size() + std::min(count, size_t(max - p) / std::max(row, size_t(1))));
 
-	// Optional, but strongly recommended; PDF 1.1
-	// dic.find("ID");
+		for (auto n = decltype(count)(0); n < count; ++n, p += row)
+		{
+			if (p + row > max)
+				throw parse_error("need cross-reference stream entry.");
 
-	// Required; must be an indirect reference
-	if (trailer.HasKey("Root"))
-	{
-		if (!m_FileTrailer.root.empty())
-			throw parse_error("dupplicated Root item");
-		m_FileTrailer.root = GetIndirectObject(trailer["Root"]);
+			size_t field[3];
+			auto q = p;
+			for (auto f = 0; f < 3; ++f)
+			{
+				field[f] = 0;
+				for (auto b = size_t(0); b < width[f]; ++b)
+					field[f] = (field[f] << 8) | *q++;
+			}
+			// The type field defaults to 1 when its width is zero.
+			if (!width[0])
+				field[0] = 1;
+
+			auto entry = Revision::Entry();
+			entry.obj_no = indirect_t(begin + n);
+			entry.used = field[0] == 1 || field[0] == 2;
+			switch (field[0])
+			{
+			case 0: // free
+				entry.revision = int(field[2]);
+				break;
+			case 1: // in use: offset, generation
+				entry.offset = long(field[1]);
+				entry.revision = int(field[2]);
+				break;
+			case 2: // compressed: object stream number, index
+				entry.container = indirect_t(field[1]);
+				entry.index = uint32_t(field[2]);
+				break;
+			default: // reserved; treat as a null reference
+				break;
+			}
+			revision.entries.push_back(entry);
+		}
 	}
+
+	return dic;
 }
 
+
 /******************************************************************************
 
 ******************************************************************************/
 
-Xref &Document::GetObject(size_t obj_no)
+void Document::PreDecode()
+{
+	// Objects are usually stored in ascending order, so let the pager read ahead.
+	Advise(Access::Sequential);
+	for (auto &xref : m_XrefTable)
+		GetObject(xref);
+}
+
+/**
+ * Every worker parses with its own cursor over the shared image and writes only
+ * the entries it was handed, so the table needs no locking.
+ */
+void Document::PreDecodeParallel()
+{
+	// Object streams first, so that compressed objects only read the cache afterwards.
+	auto containers = std::vector<indirect_t>();
+	for (const auto &xref : m_XrefTable)
+		if (xref.used && xref.container)
+			containers.push_back(xref.container);
+	std::sort(containers.begin(), containers.end());
+	containers.erase(std::unique(containers.begin(), containers.end()), containers.end());
+
+	parallel_for(containers.size(), m_Options.jobs, [&](size_t i) {
+		auto obj_no = containers[i];
+		if (obj_no >= m_XrefTable.size())
+			throw std::out_of_range("Need cross-reference table size");
+		auto &xref = m_XrefTable[obj_no];
+		if (xref.used && !xref.loaded)
+			LoadObject(xref, true);
+		GetObjectStream(obj_no);
+	});
+
+	parallel_for(m_XrefTable.size(), m_Options.jobs, [&](size_t i) {
+		auto &xref = m_XrefTable[i];
+		if (xref.used && !xref.loaded)
+			LoadObject(xref, true);
+	});
+}
+
+const Xref &Document::GetXref(size_t obj_no) const
+{
+	auto &xref = m_XrefTable.at(obj_no);
+	GetObject(xref);
+	return xref;
+}
+
+Xref &Document::GetObject(size_t obj_no) const
 {
 	if (obj_no >= m_XrefTable.size())
 		throw std::out_of_range("Need cross-reference table size");
 	return GetObject(m_XrefTable[obj_no]);
 }
 
-Xref &Document::GetObject(Xref &xref)
+Xref &Document::GetObject(Xref &xref) const
 {
 	static auto dummy = Xref();
 
 	if (!xref.used)
 		return dummy;
-	if (xref.object != Object::Type::NIL)
-		return xref;
+	if (!xref.loaded)
+		LoadObject(xref, false);
+	return xref;
+}
+
+/**
+ * Resolve an indirect reference that must point to a dictionary.
+ */
+const Object &Document::GetIndirectObject(const Object &obj) const
+{
+	const auto &object = GetObject(obj.GetIndirect()).object;
+	if (object != Object::Type::DICTIONARY)
+		throw type_error("need dictionary.");
+	return object;
+}
 
-	Seek(xref.offset);
+Object Document::Resolve(const Object &obj) const
+{
+	if (obj != Object::Type::INDIRECT)
+		return obj;
+	return LoadIsolated(obj.GetIndirect()).object;
+}
+
+/**
+ * A copy of the table entry, loaded on its own: the shared table is neither
+ * read past its location nor written, so any thread may call this.
+ */
+Xref Document::LoadIsolated(indirect_t obj_no) const
+{
+	if (obj_no >= m_XrefTable.size())
+		throw std::out_of_range("Need cross-reference table size");
+
+	const auto &location = m_XrefTable[obj_no];
+	auto r = Xref();
+	r.offset = location.offset;
+	r.used = location.used;
+	r.container = location.container;
+	r.index = location.index;
+	if (r.used)
+		LoadObject(r, true);
+	return r;
+}
+
+/**
+ * Parse an entry in place. An isolated load touches no other entry: an indirect
+ * /Length is parsed into a temporary instead of being cached in the table.
+ */
+void Document::LoadObject(Xref &xref, bool isolated) const
+{
+	auto scope = Arena::Scope(m_Arena);
+
+	// Compressed object: parse it out of the decoded object stream.
+	if (xref.container)
+	{
+		LoadObject(xref, GetObjectStream(xref.container));
+		return;
+	}
+
+	// Own cursor, so that resolving never disturbs the document position.
+	auto in = FileImage(*this);
+	in.Seek(xref.offset);
 
 	// Check begin tag: object_no revision_no 'obj'
-	auto m = GetLine(std::regex(R"(^([0-9]+) ([0-9]+) obj)"));
-	if (m.size() != 3)
+	auto no = size_t(0);
+	auto rev = size_t(0);
+	in.Skip();
+	if (!in.GetUnsigned(no) || !is_whitespace(in.GetCH()))
+		throw std::logic_error("unknown object header format");
+	in.Skip();
+	if (!in.GetUnsigned(rev) || !is_whitespace(in.GetCH()))
+		throw std::logic_error("unknown object header format");
+	in.Skip();
+	if (!in.Check("obj"))
 		throw std::logic_error("unknown object header format");
-
-	auto no = strtoul(m[1].str().c_str(), nullptr, 10);
-	auto rev = strtoul(m[2].str().c_str(), nullptr, 10);
 
 	// body
-	xref.object = Parse();
+	auto object = Parse(in);
+	auto stream = stream_t();
 
-	auto line = GetLine();
+	auto line = in.GetLine();
 	if (line == "stream")
 	{
-		auto length = xref.object["Length"];
-		auto fp = Tell();
-		auto begin = uintptr_t(Image().data() + fp);
+		auto length = object[Name::Length];
 		auto size = size_t(0);
 		if (length == Object::Type::NUMERIC)
 			size = size_t(length.GetNumeric());
 		else if (length == Object::Type::INDIRECT)
 		{
-			auto &r = GetObject(length.GetIndirect());
-			if (r.object != Object::Type::NUMERIC)
+			if (length.GetIndirect() >= m_XrefTable.size())
+				throw std::out_of_range("Need cross-reference table size");
+			auto value = isolated ? Resolve(length) : GetObject(length.GetIndirect()).object;
+			if (value != Object::Type::NUMERIC)
 				throw parse_error("Need numeric type");
-			size = size_t(r.object.GetNumeric());
-			Seek(fp);
+			size = size_t(value.GetNumeric());
 		}
 		else
 			throw parse_error("Need Length");
-		xref.stream = stream_t{begin, size};
-		Skip(size);
+		stream = stream_t{uintptr_t(Data() + in.Tell()), size};
+		in.Skip(size);
 
-		line = GetLine();
+		line = in.GetLine();
 		if (line != "endstream")
 			throw std::logic_error("endress stream...");
-		line = GetLine();
+		line = in.GetLine();
 	}
 
 	// Check end tag
 	if (line != "endobj")
 		throw std::logic_error("endress object...");
 
-	return xref;
+	xref.object = std::move(object);
+	xref.stream = stream;
+	xref.hash.Reset();
+	xref.loaded = true;
+	++m_Statistics.objects;
+}
+
+/**
+ * Parse a compressed entry out of the decoded object stream that holds it.
+ */
+void Document::LoadObject(Xref &xref, const ObjectStream &stm) const
+{
+	auto scope = Arena::Scope(m_Arena);
+
+	if (xref.index >= stm.offsets.size())
+		throw reference_error("object stream index out of range.");
+	auto in = FileImage(stm.image.data(), stm.image.size());
+	in.Seek(stm.offsets[xref.index]);
+	xref.object = Parse(in);
+	xref.hash.Reset();
+	xref.loaded = true;
+	++m_Statistics.objects;
+}
+
+/**
+ * Cached object stream of the current table. Threads asking for the same
+ * stream wait for the one decoding it; different streams decode in parallel.
+ * The container is read isolated, as the table may be filled meanwhile.
+ */
+const Document::ObjectStream &Document::GetObjectStream(indirect_t obj_no) const
+{
+	auto &cached = [&]() -> CachedObjectStream & {
+		auto lock = std::lock_guard<std::mutex>(m_ObjectStreamsLock);
+		return m_ObjectStreams[obj_no];
+	}();
+
+	std::call_once(cached.decoded, [&] {
+		// Streams are never compressed themselves (3.4.6).
+		if (obj_no < m_XrefTable.size() && m_XrefTable[obj_no].container)
+			throw parse_error("object stream inside an object stream.");
+		cached.stream = ReadObjectStream(LoadIsolated(obj_no));
+		++m_Statistics.object_streams;
+	});
+	return cached.stream;
+}
+
+/**
+ * TABLE 3.14 Additional entries specific to an object stream dictionary
+ */
+Document::ObjectStream Document::ReadObjectStream(const Xref &xref) const
+{
+	if (xref.object != Object::Type::DICTIONARY || xref.object[Name::Type] != Name::ObjStm)
+		throw parse_error("not ObjStm");
+
+	auto stm = ObjectStream();
+	stm.image = Decode(xref.object, xref.stream, false, Resolver());
+
+	// The header is N pairs of object number and offset relative to /First.
+	auto n = size_t(xref.object[Name::N].GetNumeric());
+	auto first = size_t(xref.object[Name::First].GetNumeric());
+	auto in = FileImage(stm.image.data(), stm.image.size());
+	stm.offsets.reserve(n);
+	for (auto i = decltype(n)(0); i < n; ++i)
+	{
+		auto no = size_t(0);
+		auto offset = size_t(0);
+		in.Skip();
+		if (!in.GetUnsigned(no))
+			throw parse_error("need object number in object stream.");
+		in.Skip();
+		if (!in.GetUnsigned(offset))
+			throw parse_error("need offset in object stream.");
+		stm.offsets.push_back(first + offset);
+	}
+	return stm;
 }
 
 /******************************************************************************
 
 ******************************************************************************/
 
-Document::Token Document::Lex()
+Document::Token Document::Lex(FileImage &in)
 {
-	Skip();
+	in.Skip();
 
 	// skip comment.
-	if (GetCH() == '%')
+	if (in.GetCH() == '%')
 	{
-		Skip("\r\n");
-		Skip();
+		in.Skip("\r\n");
+		in.Skip();
 	}
 
-	switch (GetCH())
+	switch (in.GetCH())
 	{
 	case 't':
-		if (GetLine(WSD) == "true")
+		if (in.GetLine(WSD) == "true")
 			return Token(Object(true));
 		throw parse_error("Unknown Token");
 
 	case 'f':
-		if (GetLine(WSD) == "false")
+		if (in.GetLine(WSD) == "false")
 			return Token(Object(false));
 		throw parse_error("Unknown Token");
 
+	case 'n':
+		if (in.GetLine(WSD) == "null")
+			return Token(Object());
+		throw parse_error("Unknown Token");
+
 	case '+':
 	case '-':
+	case '.':
 	case '0':
 	case '1':
 	case '2':
@@ -431,42 +1794,50 @@ Document::Token Document::Lex()
 	case '8':
 	case '9':
 	{
-		static auto r = std::regex(R"(^([0-9]+) ([0-9]+) R)");
-		auto m = GetLine(r);
-		if (m.ready() && !m.empty())
+		// Look ahead for an indirect reference: object_no generation_no 'R'
+		auto fp = in.Tell();
+		auto no = size_t(0);
+		auto gen = size_t(0);
+		if (in.GetUnsigned(no) && is_whitespace(in.GetCH()))
 		{
-			auto t1 = strtoul(m[1].str().c_str(), nullptr, 10);
-			auto t2 = strtoul(m[2].str().c_str(), nullptr, 10);
-			if (t2 > 0)
-				throw parse_error("No support for non-zero generation.");
-			return Token(Object(indirect_t{t1}));
+			in.Skip();
+			if (in.GetUnsigned(gen) && is_whitespace(in.GetCH()))
+			{
+				in.Skip();
+				if (in.Check("R") && (is_whitespace(in.GetCH()) || is_delimiter(in.GetCH())))
+				{
+					if (gen > UINT16_MAX)
+						throw parse_error("generation out of range.");
+					return Token(Object(indirect_t(no), uint16_t(gen)));
+				}
+			}
 		}
-		return Token(Object(strtod(GetLine(WSD).data(), nullptr)));
+		in.Seek(fp);
+		return Token(Object(parse_numeric(in.GetLine(WSD))));
 	}
 
 	case '(':
 	{
-		auto begin = Tell();
+		auto begin = in.Tell();
 		auto stack = 0;
 		for (;;)
 		{
-			auto ch = Get();
+			auto ch = in.Get();
 			if (ch == '\\')
 			{
-				ch = Get();
+				ch = in.Get();
 				if (std::string_view("nrtbf()\\").find_first_of(ch) != std::string_view::npos)
 					; // escape
 				else if (ch >= '0' && ch <= '9')
 				{
-					auto m = Check(std::regex(R"(([0-9][1,4]))"));
 					// Oct 3-digit(\ddd) or 2-digit(\dd)
-					if ((ch = Get()) < '0' || ch > '9')
+					if ((ch = in.Get()) < '0' || ch > '9')
 						throw std::logic_error("");
-					if ((ch = Get()) < '0' || ch > '9')
-						Unget();
+					if ((ch = in.Get()) < '0' || ch > '9')
+						in.Unget();
 				}
 				else
-					Unget();
+					in.Unget();
 			}
 			else if (ch == '(')
 				++stack;
@@ -474,19 +1845,19 @@ Document::Token Document::Lex()
 				if (--stack == 0)
 					break;
 		}
-		return Token(Object(string_t{Image().data() + begin, Tell() - begin}));
+		return Token(Object(string_t{in.Data() + begin, in.Tell() - begin}));
 	}
 
 	case '<':
-		if (Check("<<"))
+		if (in.Check("<<"))
 			return Token(TokenType::DictionaryBegin);
 		else
 		{
-			auto begin = Tell();
+			auto begin = in.Tell();
 			auto stack = 0;
 			for (;;)
 			{
-				auto ch = Get();
+				auto ch = in.Get();
 				if (is_hex(ch))
 					;
 				else if (ch == '<')
@@ -499,39 +1870,39 @@ Document::Token Document::Lex()
 				else if (!is_whitespace(ch))
 					throw parse_error("Failed parse hex string.");
 			}
-			return Token(Object(string_t{Image().data() + begin, Tell() - begin}));
+			return Token(Object(string_t{in.Data() + begin, in.Tell() - begin}));
 		}
 
 	case '>':
-		if (Check(">>"))
+		if (in.Check(">>"))
 			return Token(TokenType::DictionaryEnd);
 		throw parse_error("Unknown Token");
 
 	case '/':
-		Get();
-		return Token(Object(name_t{GetLine(WSD)}));
+		in.Get();
+		return Token(Object(name_t(in.GetLine(WSD))));
 
 	case '[':
-		Get();
+		in.Get();
 		return Token(TokenType::ArrayBegin);
 	case ']':
-		Get();
+		in.Get();
 		return Token(TokenType::ArrayEnd);
 
 	case 's':
-		if (Check("stream"))
+		if (in.Check("stream"))
 		{
 			// Only CRLF or LF line breaks are permitted on the start-of-stream line, so skip to LF.
-			while (Get() != '\n')
+			while (in.Get() != '\n')
 				;
 			return Token(TokenType::StreamBegin);
 		}
 		throw parse_error("Unknown Token");
 
 	case 'e':
-		if (Check("endstream"))
+		if (in.Check("endstream"))
 			return Token(TokenType::StreamEnd);
-		if (Check("endobj"))
+		if (in.Check("endobj"))
 			return Token(TokenType::ObjectEnd);
 		throw parse_error("Unknown Token");
 	}
@@ -539,9 +1910,9 @@ Document::Token Document::Lex()
 	throw parse_error("Unknown Token");
 }
 
-Object Document::Parse(Token stock)
+Object Document::Parse(FileImage &in, Token stock)
 {
-	auto token = !stock.type ? Lex() : stock;
+	auto token = !stock.type ? Lex(in) : std::move(stock);
 	stock.type = 0;
 
 	switch (token.type)
@@ -551,15 +1922,15 @@ Object Document::Parse(Token stock)
 		auto array = array_t();
 		for (;;)
 		{
-			auto value = Lex();
+			auto value = Lex(in);
 			if (value == TokenType::ArrayEnd)
 				break;
 			if (value.type == TokenType::ArrayBegin || value.type == TokenType::DictionaryBegin)
-				array.emplace_back(Parse(value));
+				array.emplace_back(Parse(in, value));
 			else
-				array.emplace_back(value.object);
+				array.emplace_back(std::move(value.object));
 		}
-		return Object(array);
+		return Object(std::move(array));
 	}
 
 	case TokenType::DictionaryBegin:
@@ -567,22 +1938,22 @@ Object Document::Parse(Token stock)
 		auto dic = dictionary_t();
 		for (;;)
 		{
-			auto name = Lex();
+			auto name = Lex(in);
 			if (name == TokenType::DictionaryEnd)
 				break;
 			if (name != int(Object::Type::NAME))
 				throw parse_error("need Name.");
-			auto value = Lex();
+			auto value = Lex(in);
 			if (value.type == TokenType::ArrayBegin || value.type == TokenType::DictionaryBegin)
-				dic[name.object.GetName()] = Parse(value);
+				dic[name.object.GetName()] = Parse(in, value);
 			else
-				dic[name.object.GetName()] = value.object;
+				dic[name.object.GetName()] = std::move(value.object);
 		}
-		return Object(dic);
+		return Object(std::move(dic));
 	}
 
 	default:
-		return token.object;
+		return std::move(token.object);
 	}
 }
 
@@ -596,11 +1967,22 @@ std::ostream &operator<<(std::ostream &out, const PDF::Document &doc)
 		<< std::setw(10) << "no" << ' ' << std::setw(10) << "xref" << ' ' << std::setw(5) << "rev" << ' ' << std::setw(6) << "used"
 		<< " object" << std::endl;
 
-	auto index = 0;
-	for (const auto &xref : doc.GetXrefTable())
+	// Rows go through one buffer, written out a block at a time.
+	auto rows = std::string();
+	auto printer = Printer(rows);
+	auto table_size = doc.GetXrefSize();
+	for (auto i = decltype(table_size)(0); i < table_size; ++i)
 	{
-		out << std::setw(10) << index << ' ' << xref << std::endl;
-		++index;
+		printer.Column(i, 10);
+		rows += ' ';
+		printer.Print(doc.GetXref(i));
+		rows += '\n';
+		if (rows.size() >= 64 * 1024)
+		{
+			out.write(rows.data(), rows.size());
+			rows.clear();
+		}
 	}
-	return out;
+	out.write(rows.data(), rows.size());
+	return out << std::flush;
 }
@@ -1,27 +1,173 @@
 #pragma once
 
 #include "file_image.h"
+#include "pdf_arena.h"
+#include "pdf_content.h"
 #include "pdf_except.h"
+#include "pdf_filter.h"
+#include "pdf_fingerprint.h"
+#include "pdf_report.h"
 #include "pdf_xref.h"
 #include "pdf_object.h"
+#include <atomic>
 #include <iomanip>
+#include <map>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <vector>
 
 namespace PDF
 {
+	struct Options
+	{
+		// Parse every object while opening instead of on first access.
+		bool eager = false;
+
+		// Threads for pre-decoding; more than one implies eager.
+		size_t jobs = 1;
+
+		// Compare streams by their decoded content instead of their raw bytes.
+		bool decoded = false;
+
+		// Also compare the content of every page operator by operator.
+		bool operators = false;
+
+		// Match pages and objects by structure instead of object number.
+		bool semantic = false;
+
+		// Compare only this page (0-based) and what it refers to.
+		static constexpr size_t all_pages = SIZE_MAX;
+		size_t page = all_pages;
+	};
+
+	struct Statistics
+	{
+		std::atomic<size_t> objects{0};
+		std::atomic<size_t> object_streams{0};
+		std::atomic<size_t> operators{0};
+	};
+
+	/**
+	 * A leaf of the page tree with the attributes it inherits from its
+	 * ancestors (TABLE 3.27, inheritable entries). Attributes that are not set
+	 * anywhere on the way stay null.
+	 */
+	struct Page
+	{
+		indirect_t obj_no = 0;
+		Object resources;
+		Object media_box;
+		Object crop_box;
+		Object rotate;
+	};
+
+	/**
+	 * 3.4.5 Incremental Updates: one cross-reference section and the entries
+	 * it defines. Revision 0 is the original document; every later one
+	 * overlays the ones before.
+	 */
+	struct Revision
+	{
+		// Where an entry points; the objects themselves live in the xref table.
+		struct Entry
+		{
+			indirect_t obj_no = 0;
+			int revision = 0;
+			long offset = 0;
+			indirect_t container = 0;
+			uint32_t index = 0;
+			bool used = false;
+		};
+
+		size_t offset = 0; // of the cross-reference section
+		std::vector<Entry> entries;
+	};
+
+	/**
+	 * F.2 Linearization Parameter Dictionary (TABLE F.1), with the page
+	 * offsets from the page offset hint table (TABLE F.3, F.4).
+	 */
+	struct Linearization
+	{
+		size_t length = 0; // L
+		size_t hint_offset = 0; // H, first hint stream only
+		size_t hint_length = 0;
+		indirect_t first_page = 0; // O
+		size_t first_page_end = 0; // E
+		size_t pages = 0; // N
+		size_t main_xref = 0; // T
+
+		// File offset of the page object of every page; empty if the hint
+		// table is missing or does not match the file.
+		std::vector<size_t> page_offsets;
+	};
+
 	class Document : public FileImage
 	{
 	public:
-		Document(std::string_view name);
+		Document(std::string_view name, const Options &options = Options());
 
 		bool operator==(const Document &r) const;
-		void diff(std::ostream &out, const Document &r) const;
+		void diff(DiffReport &report, const Document &r) const;
+
+		/**
+		 * Equal fingerprints mean operator== holds; --decoded is taken into
+		 * account. Loads every object.
+		 */
+		Fingerprint GetFingerprint() const;
+
+		/**
+		 * Comparisons with the document `golden` was taken from, which stands
+		 * on the left. Matches stops at the first difference, as operator==
+		 * does, so objects are only loaded up to it; diff names every changed
+		 * object.
+		 */
+		bool Matches(const Fingerprint &golden) const;
+		void diff(DiffReport &report, const Fingerprint &golden) const;
 
 		bool Analyze();
 
 		std::string_view GetVersion() const { return m_Version; }
-		std::vector<Xref> GetXrefTable() const { return m_XrefTable; }
+		size_t GetXrefSize() const noexcept { return m_XrefTable.size(); }
+		const Xref &GetXref(size_t obj_no) const;
+
+		size_t GetRevisionCount() const noexcept { return m_Revisions.size(); }
+		const Revision &GetRevision(size_t index) const { return m_Revisions.at(index); }
+
+		/**
+		 * What the last `count` revisions changed: only the objects their
+		 * sections define are compared with the state before them.
+		 */
+		void DiffRevisions(DiffReport &report, size_t count) const;
+
+		/**
+		 * The pages in order. The page tree is walked once, on the first call.
+		 */
+		size_t GetPageCount() const { return GetPageIndex().size(); }
+		const Page &GetPage(size_t index) const { return GetPageIndex().at(index); }
+
+		/**
+		 * Walk the document structure from the catalog down to the resources
+		 * of every page, one note per dictionary; shared resources are noted
+		 * once.
+		 */
+		void Traverse(DiffReport &report) const;
+
+		/**
+		 * Parameters of a linearized file, read on the first call; null if the
+		 * file is not linearized or was updated since (/L is not its size).
+		 */
+		const Linearization *GetLinearization() const;
+
+		/**
+		 * Object number of a page, 0 if there is no such page. A linearized
+		 * file is asked first, so that the page tree is not walked.
+		 */
+		indirect_t LocatePage(size_t index) const;
+
+		const Statistics &GetStatistics() const noexcept { return m_Statistics; }
+		const Arena &GetArena() const noexcept { return m_Arena; }
 
 	private:
 		enum TokenType
@@ -41,37 +187,121 @@ namespace PDF
 			Object object;
 
 			Token(int type = int(Object::Type::NIL)) : type(type) {}
-			Token(Object object) : object(object) { type = int(object.GetType()); }
+			Token(Object object) : object(std::move(object)) { type = int(this->object.GetType()); }
 
 			bool operator==(int r) const noexcept { return type == r; }
 			bool operator!=(int r) const noexcept { return type != r; }
 		};
 
+		Options m_Options;
 		std::string_view m_Version;
-		std::vector<Xref> m_XrefTable;
+
+		// Owns every Object, Array, Dictionary and name of the document; declared
+		// first so that it is released last, in one go.
+		mutable Arena m_Arena;
+
+		// Entries are resolved on first access, also through const methods.
+		mutable std::vector<Xref> m_XrefTable;
+
+		// Oldest first; m_XrefTable is their overlay.
+		std::vector<Revision> m_Revisions;
+		mutable Statistics m_Statistics;
 
 		struct
 		{
 			size_t size = 0;
-			dictionary_t root;
-			dictionary_t info;
+			// Handles to the dictionaries in the object table, not copies.
+			Object root;
+			Object info;
 		} m_FileTrailer;
 
-		void ParseXrefTable();
-		void ParseCatalog(dictionary_t &dic);
-		void ParseOutlines(dictionary_t &dic);
-		void ParseMetadata(dictionary_t &dic);
-		void ParsePages(dictionary_t &dic);
-		void ParsePage(dictionary_t &dic);
-		void ParseResources(dictionary_t &dic);
-		void ParseFont(dictionary_t &dic);
-
-		Xref &GetObject(size_t obj_no);
-		Xref &GetObject(Xref &xref);
-		dictionary_t GetIndirectObject(const Object &obj) { return GetObject(obj.GetIndirect()).object.GetDictionary(); }
-
-		Token Lex();
-		Object Parse(Token stock = Token());
+		/**
+		 * Decoded object stream (/Type /ObjStm) with the offsets of the objects it holds.
+		 * Inflated the first time one of its objects is requested.
+		 */
+		struct ObjectStream
+		{
+			std::vector<char> image;
+			std::vector<size_t> offsets;
+		};
+		struct CachedObjectStream
+		{
+			std::once_flag decoded;
+			ObjectStream stream;
+		};
+		// The lock guards the map; each entry is decoded once through its flag.
+		mutable std::map<indirect_t, CachedObjectStream> m_ObjectStreams;
+		mutable std::mutex m_ObjectStreamsLock;
+
+		// Flattened page tree, built on first access.
+		mutable std::vector<Page> m_PageIndex;
+		mutable std::once_flag m_PageIndexBuilt;
+
+		mutable std::optional<Linearization> m_Linearization;
+		mutable std::once_flag m_LinearizationParsed;
+
+		void ParseRevisions(size_t offset);
+		Object ParseXrefTable(Revision &revision);
+		Object ParseXrefStream(Revision &revision);
+
+		// State of one Traverse: where the notes go, and the indirect objects
+		// already handled.
+		struct Traversal
+		{
+			DiffReport &report;
+			std::vector<bool> visited;
+
+			bool FirstVisit(const Object &obj);
+		};
+		void ParseCatalog(Traversal &t, const dictionary_t &dic) const;
+		void ParseOutlines(Traversal &t, const dictionary_t &dic) const;
+		void ParseMetadata(Traversal &t, const dictionary_t &dic) const;
+		void ParsePages(Traversal &t, const dictionary_t &dic) const;
+		void ParsePage(Traversal &t, size_t index, const Page &page) const;
+		void ParseResources(Traversal &t, const dictionary_t &dic) const;
+		void ParseFont(Traversal &t, const dictionary_t &dic) const;
+		void ParseXObject(Traversal &t, const dictionary_t &dic) const;
+
+		const std::vector<Page> &GetPageIndex() const;
+		void BuildPageIndex() const;
+		void ParseLinearization() const;
+		std::vector<size_t> ParseHintTable(const Linearization &linearization) const;
+		indirect_t GetObjectAt(size_t offset) const;
+		std::vector<indirect_t> GetReachable(indirect_t obj_no, int &depth) const;
+		std::vector<const Xref *> GetContentStreams(const dictionary_t &page) const;
+		std::vector<hash_t> GetGraphHashes() const;
+		std::vector<hash_t> GetGraphHashes(const std::vector<indirect_t> &objects, int rounds) const;
+
+		struct ContentReport
+		{
+			std::string error;
+			DiffReport report;
+		};
+		std::vector<ContentReport> DiffContents(const Document &r, const std::vector<std::pair<indirect_t, indirect_t>> &pages) const;
+		void DiffPages(DiffReport &report, const Document &r) const;
+		void DiffSemantic(DiffReport &report, const Document &r) const;
+		void DiffPage(DiffReport &report, const Document &r, size_t index) const;
+
+		void PreDecode();
+		void PreDecodeParallel();
+
+		hash_t GetEntryHash(size_t obj_no, bool decoded, const resolver_t &resolve) const;
+		Xref &GetObject(size_t obj_no) const;
+		Xref &GetObject(Xref &xref) const;
+		void LoadObject(Xref &xref, bool isolated) const;
+		void LoadObject(Xref &xref, const ObjectStream &stm) const;
+		const ObjectStream &GetObjectStream(indirect_t obj_no) const;
+		ObjectStream ReadObjectStream(const Xref &xref) const;
+		const Object &GetIndirectObject(const Object &obj) const;
+		Xref LoadIsolated(indirect_t obj_no) const;
+
+		// Loads the referenced object the way an isolated load does, so that
+		// streams can be decoded on any thread; other objects pass through.
+		Object Resolve(const Object &obj) const;
+		resolver_t Resolver() const { return [this](const Object &obj) { return Resolve(obj); }; }
+
+		static Token Lex(FileImage &in);
+		static Object Parse(FileImage &in, Token stock = Token());
 	};
 }
 
@@ -0,0 +1,88 @@
+#include "pdf_arena.h"
+#include <algorithm>
+
+using namespace PDF;
+
+namespace
+{
+	const size_t chunk_size = 64 * 1024;
+
+	std::atomic<uint64_t> next_id{1};
+
+	// The chunk this thread is currently carving from, tagged with the owning arena.
+	struct Cursor
+	{
+		uint64_t id = 0;
+		char *head = nullptr;
+		char *tail = nullptr;
+	};
+
+	// One cursor per recently used arena, so a thread that alternates between
+	// documents keeps filling its chunks instead of starting a new one each time.
+	const size_t cursor_slots = 4;
+	thread_local Cursor cursors[cursor_slots];
+	thread_local size_t next_slot = 0;
+	thread_local std::pmr::memory_resource *current = nullptr;
+
+	char *align_up(char *p, size_t alignment)
+	{
+		auto v = reinterpret_cast<uintptr_t>(p);
+		return reinterpret_cast<char *>((v + alignment - 1) & ~uintptr_t(alignment - 1));
+	}
+}
+
+Arena::Arena() : m_Id(next_id++) {}
+
+size_t Arena::GetChunks() const
+{
+	auto lock = std::lock_guard<std::mutex>(m_Lock);
+	return m_Chunks.size();
+}
+
+std::pmr::memory_resource *Arena::Current() noexcept
+{
+	// Boxed payloads are never freed one by one, so outside a scope there is
+	// nothing that could own them.
+	return current ? current : std::pmr::null_memory_resource();
+}
+
+Arena::Scope::Scope(Arena &arena) noexcept : m_Previous(current) { current = &arena; }
+Arena::Scope::~Scope() noexcept { current = m_Previous; }
+
+void *Arena::do_allocate(size_t bytes, size_t alignment)
+{
+	m_Allocations.fetch_add(1, std::memory_order_relaxed);
+	m_Bytes.fetch_add(bytes, std::memory_order_relaxed);
+
+	auto cursor = static_cast<Cursor *>(nullptr);
+	for (auto &slot : cursors)
+		if (slot.id == m_Id)
+			cursor = &slot;
+	if (cursor)
+	{
+		auto p = align_up(cursor->head, alignment);
+		if (p + bytes <= cursor->tail)
+		{
+			cursor->head = p + bytes;
+			return p;
+		}
+	}
+
+	// Large requests get a chunk of their own and leave the current one alone.
+	auto size = std::max(chunk_size, bytes + alignment);
+	auto chunk = std::make_unique<char[]>(size);
+	auto head = chunk.get();
+	{
+		auto lock = std::lock_guard<std::mutex>(m_Lock);
+		m_Chunks.push_back(std::move(chunk));
+	}
+
+	auto p = align_up(head, alignment);
+	if (size == chunk_size)
+	{
+		if (!cursor)
+			cursor = &cursors[next_slot++ % cursor_slots];
+		*cursor = Cursor{m_Id, p + bytes, head + size};
+	}
+	return p;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace PDF
+{
+	/**
+	 * Monotonic memory for the object graph of one document.
+	 *
+	 * Every thread carves its allocations out of a chunk of its own, so the
+	 * common path takes no lock. Deallocation is a no-op and all chunks are
+	 * released at once when the arena is destroyed.
+	 */
+	class Arena : public std::pmr::memory_resource
+	{
+	public:
+		Arena();
+		Arena(const Arena &) = delete;
+		Arena &operator=(const Arena &) = delete;
+
+		size_t GetAllocations() const noexcept { return m_Allocations; }
+		size_t GetBytes() const noexcept { return m_Bytes; }
+		size_t GetChunks() const;
+
+		/**
+		 * Resource for containers created on this thread: the arena of the
+		 * innermost Scope. Outside any scope it is null_memory_resource(), so
+		 * allocating throws std::bad_alloc instead of leaking.
+		 */
+		static std::pmr::memory_resource *Current() noexcept;
+
+		class Scope
+		{
+		public:
+			Scope(Arena &arena) noexcept;
+			~Scope() noexcept;
+
+			Scope(const Scope &) = delete;
+			Scope &operator=(const Scope &) = delete;
+
+		private:
+			std::pmr::memory_resource *m_Previous;
+		};
+
+	private:
+		void *do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void *, size_t, size_t) override {}
+		bool do_is_equal(const std::pmr::memory_resource &r) const noexcept override { return this == &r; }
+
+		const uint64_t m_Id;
+		mutable std::mutex m_Lock;
+		std::vector<std::unique_ptr<char[]>> m_Chunks;
+		std::atomic<size_t> m_Allocations{0};
+		std::atomic<size_t> m_Bytes{0};
+	};
+}
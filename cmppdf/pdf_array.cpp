@@ -1,48 +1,53 @@
 #include "pdf_array.h"
 #include "pdf_object.h"
-#include <sstream>
+#include "pdf_printer.h"
+#include "pdf_report.h"
+#include <algorithm>
 
 using namespace PDF;
 
+std::atomic<size_t> Array::s_Copies{0};
+
+/**
+ * Different hashes reject at once; equal ones can still collide, so the
+ * entries are compared then.
+ */
 bool Array::operator==(const Array &r) const noexcept
 {
-	if (size() != r.size())
+	if (size() != r.size() || Hash() != r.Hash())
 		return false;
-	for (auto i = size_t(0); i < size(); ++i)
-		if (at(i) != r.at(i))
-			return false;
-	return true;
+	return std::equal(begin(), end(), r.begin());
 }
 
-void Array::diff(std::ostream &out, const Array &r, size_t depth) const noexcept
+void Array::diff(DiffReport &report, const Array &r, size_t depth) const noexcept
 {
 	if (size() != r.size())
-		out << "Array size: " << size() << " / " << r.size() << std::endl;
+		report.Changed(depth, "Array size", size(), r.size());
 	else
 		for (auto i = size_t(0); i < size(); ++i)
 		{
 			auto &lobj = at(i);
 			auto &robj = r.at(i);
 			if (lobj != robj)
-				lobj.diff(out, robj, depth + 1);
+				lobj.diff(report, robj, depth + 1);
 		}
 }
 
+hash_t Array::Hash() const
+{
+	return m_Hash.Get([this] {
+		auto h = HashCombine(0, size());
+		for (const auto &obj : *this)
+			h = HashCombine(h, obj.Hash());
+		return h;
+	});
+}
+
 std::string Array::Display() const noexcept
 {
-	auto ss = std::stringstream();
-	for (const auto &obj : *this)
-		ss << obj.Display() << ' ';
-	auto s = ss.str();
-	auto length = s.length();
-	if (length > 32)
-	{
-		ss.str("");
-		ss.clear(std::ios_base::goodbit);
-		ss << ".." << length << "..";
-		s = ss.str();
-	}
-	return "[" + s + "]";
+	auto s = std::string();
+	Printer(s).Print(*this);
+	return s;
 }
 
 /******************************************************************************
@@ -1,23 +1,55 @@
 #pragma once
 
+#include "pdf_arena.h"
+#include "pdf_hash.h"
 #include <ostream>
 #include <vector>
 
 namespace PDF
 {
 	class Object;
-	using array_parent_t = std::vector<Object>;
+	class DiffReport;
+	using array_parent_t = std::pmr::vector<Object>;
 
 	class Array : public array_parent_t
 	{
 	public:
+		Array() : array_parent_t(Arena::Current()) {}
+		Array(const Array &r) : array_parent_t(r, Arena::Current()), m_Hash(r.m_Hash) { ++s_Copies; }
+		Array(Array &&r) = default;
 		virtual ~Array() = default;
 
+		Array &operator=(const Array &r)
+		{
+			++s_Copies;
+			array_parent_t::operator=(r);
+			m_Hash = r.m_Hash;
+			return *this;
+		}
+		Array &operator=(Array &&r) = default;
+
 		bool operator==(const Array &r) const noexcept;
 		bool operator!=(const Array &r) const noexcept { return !(*this == r); }
-		void diff(std::ostream &out, const Array &r, size_t depth = 0) const noexcept;
+		void diff(DiffReport &report, const Array &r, size_t depth = 0) const noexcept;
+
+		/**
+		 * Structural hash, computed on first use. Equal hashes are taken as
+		 * equal contents, so equality and diff only descend where they differ.
+		 */
+		hash_t Hash() const;
 
 		std::string Display() const noexcept;
+
+		/**
+		 * Deep copies made so far, by all threads. Parsing and traversal only
+		 * move containers, so this stays zero unless a caller copies one.
+		 */
+		static size_t GetCopies() noexcept { return s_Copies; }
+
+	private:
+		static std::atomic<size_t> s_Copies;
+
+		HashCache m_Hash;
 	};
 }
 
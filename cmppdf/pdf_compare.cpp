@@ -0,0 +1,743 @@
+#include "pdf_compare.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define PDF_COMPARE_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PDF_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define PDF_TARGET_AVX2
+#endif
+
+using namespace PDF;
+
+namespace
+{
+	using kernel_t = ByteMismatch (*)(const unsigned char *, const unsigned char *, size_t, bool);
+
+	inline unsigned count_bits(uint32_t x)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return unsigned(__builtin_popcount(x));
+#else
+		x = x - ((x >> 1) & 0x55555555u);
+		x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+		return unsigned((((x + (x >> 4)) & 0x0f0f0f0fu) * 0x01010101u) >> 24);
+#endif
+	}
+
+	inline unsigned lowest_bit(uint32_t x)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return unsigned(__builtin_ctz(x));
+#else
+		auto n = 0u;
+		while (!(x & 1))
+			x >>= 1, ++n;
+		return n;
+#endif
+	}
+
+	/**
+	 * Fold the difference mask of one block of `width` bytes into the result.
+	 * `carry` tells whether the byte before the block differed. Returns false
+	 * once the caller may stop.
+	 */
+	inline bool account(ByteMismatch &result, bool &carry, uint32_t mask, unsigned width, size_t offset, bool count_ranges)
+	{
+		if (!mask)
+		{
+			carry = false;
+			return true;
+		}
+		if (result.first == ByteMismatch::npos)
+			result.first = offset + lowest_bit(mask);
+		if (!count_ranges)
+		{
+			result.ranges = 1;
+			return false;
+		}
+		// A run starts at every differing byte whose predecessor matched.
+		result.ranges += count_bits(mask & ~((mask << 1) | uint32_t(carry)));
+		carry = (mask >> (width - 1)) & 1;
+		return true;
+	}
+
+	ByteMismatch compare_tail(const unsigned char *l, const unsigned char *r, size_t begin, size_t size, bool count_ranges, ByteMismatch result, bool carry)
+	{
+		for (auto i = begin; i < size; ++i)
+			if (!account(result, carry, l[i] != r[i], 1, i, count_ranges))
+				break;
+		return result;
+	}
+
+	ByteMismatch compare_scalar(const unsigned char *l, const unsigned char *r, size_t size, bool count_ranges)
+	{
+		auto result = ByteMismatch();
+		auto carry = false;
+		auto i = size_t(0);
+		for (; i + 8 <= size; i += 8)
+		{
+			uint64_t a, b;
+			std::memcpy(&a, l + i, 8);
+			std::memcpy(&b, r + i, 8);
+			if (a == b)
+			{
+				carry = false;
+				continue;
+			}
+			auto mask = uint32_t(0);
+			for (auto k = 0u; k < 8; ++k)
+				mask |= uint32_t(l[i + k] != r[i + k]) << k;
+			if (!account(result, carry, mask, 8, i, count_ranges))
+				return result;
+		}
+		return compare_tail(l, r, i, size, count_ranges, result, carry);
+	}
+
+#ifdef PDF_COMPARE_X86
+	ByteMismatch compare_sse2(const unsigned char *l, const unsigned char *r, size_t size, bool count_ranges)
+	{
+		auto result = ByteMismatch();
+		auto carry = false;
+		auto i = size_t(0);
+		auto load = [](const unsigned char *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); };
+		auto mask = [](__m128i eq) { return ~uint32_t(_mm_movemask_epi8(eq)) & 0xffffu; };
+		for (; i + 64 <= size; i += 64)
+		{
+			// Equal blocks are by far the common case; test four at once.
+			auto eq0 = _mm_cmpeq_epi8(load(l + i), load(r + i));
+			auto eq1 = _mm_cmpeq_epi8(load(l + i + 16), load(r + i + 16));
+			auto eq2 = _mm_cmpeq_epi8(load(l + i + 32), load(r + i + 32));
+			auto eq3 = _mm_cmpeq_epi8(load(l + i + 48), load(r + i + 48));
+			auto all = _mm_and_si128(_mm_and_si128(eq0, eq1), _mm_and_si128(eq2, eq3));
+			if (_mm_movemask_epi8(all) == 0xffff)
+			{
+				carry = false;
+				continue;
+			}
+			if (!account(result, carry, mask(eq0), 16, i, count_ranges) ||
+				!account(result, carry, mask(eq1), 16, i + 16, count_ranges) ||
+				!account(result, carry, mask(eq2), 16, i + 32, count_ranges) ||
+				!account(result, carry, mask(eq3), 16, i + 48, count_ranges))
+				return result;
+		}
+		for (; i + 16 <= size; i += 16)
+			if (!account(result, carry, mask(_mm_cmpeq_epi8(load(l + i), load(r + i))), 16, i, count_ranges))
+				return result;
+		return compare_tail(l, r, i, size, count_ranges, result, carry);
+	}
+
+	// A lambda would not inherit the target attribute of the kernel.
+	PDF_TARGET_AVX2 inline __m256i load256(const unsigned char *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+
+	PDF_TARGET_AVX2 ByteMismatch compare_avx2(const unsigned char *l, const unsigned char *r, size_t size, bool count_ranges)
+	{
+		auto result = ByteMismatch();
+		auto carry = false;
+		auto i = size_t(0);
+		for (; i + 128 <= size; i += 128)
+		{
+			auto eq0 = _mm256_cmpeq_epi8(load256(l + i), load256(r + i));
+			auto eq1 = _mm256_cmpeq_epi8(load256(l + i + 32), load256(r + i + 32));
+			auto eq2 = _mm256_cmpeq_epi8(load256(l + i + 64), load256(r + i + 64));
+			auto eq3 = _mm256_cmpeq_epi8(load256(l + i + 96), load256(r + i + 96));
+			auto all = _mm256_and_si256(_mm256_and_si256(eq0, eq1), _mm256_and_si256(eq2, eq3));
+			if (uint32_t(_mm256_movemask_epi8(all)) == 0xffffffffu)
+			{
+				carry = false;
+				continue;
+			}
+			if (!account(result, carry, ~uint32_t(_mm256_movemask_epi8(eq0)), 32, i, count_ranges) ||
+				!account(result, carry, ~uint32_t(_mm256_movemask_epi8(eq1)), 32, i + 32, count_ranges) ||
+				!account(result, carry, ~uint32_t(_mm256_movemask_epi8(eq2)), 32, i + 64, count_ranges) ||
+				!account(result, carry, ~uint32_t(_mm256_movemask_epi8(eq3)), 32, i + 96, count_ranges))
+				return result;
+		}
+		for (; i + 32 <= size; i += 32)
+		{
+			auto eq = _mm256_cmpeq_epi8(load256(l + i), load256(r + i));
+			if (!account(result, carry, ~uint32_t(_mm256_movemask_epi8(eq)), 32, i, count_ranges))
+				return result;
+		}
+		return compare_tail(l, r, i, size, count_ranges, result, carry);
+	}
+
+	bool has_avx2()
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+		// AVX2 needs both the instructions and an OS that saves the YMM registers.
+		int info[4];
+		__cpuid(info, 1);
+		if (!(info[2] & (1 << 27)) || (_xgetbv(0) & 6) != 6)
+			return false;
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		return false;
+#endif
+	}
+#endif
+
+	struct Dispatch
+	{
+		kernel_t kernel = compare_scalar;
+		const char *name = "scalar";
+
+		Dispatch()
+		{
+#ifdef PDF_COMPARE_X86
+			// SSE2 is part of x86-64.
+			kernel = compare_sse2;
+			name = "sse2";
+			if (has_avx2())
+			{
+				kernel = compare_avx2;
+				name = "avx2";
+			}
+#endif
+		}
+	};
+
+	const Dispatch &dispatch()
+	{
+		static const auto instance = Dispatch();
+		return instance;
+	}
+
+	/**************************************************************************
+
+	**************************************************************************/
+
+	// Realignment hashes blocks of this many bytes and looks at most
+	// window_blocks blocks ahead on either side.
+	const size_t block_size = 64;
+	const size_t window_blocks = 16384;
+	const size_t window_size = block_size * window_blocks;
+
+	// Polynomial rolling hash over block_size bytes, modulo 2^64.
+	const uint64_t roll_base = 0x100000001b3ULL;
+
+	uint64_t roll_power()
+	{
+		auto p = uint64_t(1);
+		for (auto i = size_t(1); i < block_size; ++i)
+			p *= roll_base;
+		return p;
+	}
+
+	const uint64_t roll_out = roll_power();
+
+	inline uint64_t block_hash(const unsigned char *p)
+	{
+		auto h = uint64_t(0);
+		for (auto i = size_t(0); i < block_size; ++i)
+			h = h * roll_base + p[i];
+		return h;
+	}
+
+	inline uint64_t roll(uint64_t h, unsigned char out, unsigned char in)
+	{
+		return (h - out * roll_out) * roll_base + in;
+	}
+
+	/**
+	 * Open-addressing table from block hash to the blocks of the left side
+	 * with that hash, oldest first. Blocks lie on a fixed grid from the first
+	 * position indexed, so that the window only slides forward: blocks behind
+	 * the current position leave, the ones that come into reach are added.
+	 */
+	class BlockIndex
+	{
+	public:
+		static constexpr size_t none = SIZE_MAX;
+
+		/**
+		 * Index the grid blocks that lie within [from, end), at most
+		 * window_blocks of them. `from` never goes back between calls.
+		 */
+		void Slide(const unsigned char *base, size_t from, size_t end)
+		{
+			if (m_Slots.empty())
+			{
+				m_Slots.assign(capacity, Slot());
+				m_Hashes.resize(window_blocks);
+				m_Next.resize(window_blocks);
+				m_Filter.assign(filter_bits / 64, 0);
+				m_Base = base;
+				m_Origin = from;
+				m_First = m_End = 0;
+			}
+
+			auto first = (from - m_Origin + block_size - 1) / block_size;
+			auto last = end - m_Origin < block_size ? 0 : (end - m_Origin - block_size) / block_size + 1;
+			last = std::max(first, std::min(last, first + window_blocks));
+
+			if (first >= m_End)
+			{
+				// Nothing left in reach: start over rather than remove block by block.
+				std::fill(m_Slots.begin(), m_Slots.end(), Slot());
+				std::fill(m_Filter.begin(), m_Filter.end(), 0);
+				m_Removed = 0;
+				m_First = m_End = first;
+			}
+			for (; m_First < first; ++m_First)
+				Remove(m_First);
+			for (; m_End < last; ++m_End)
+				Add(m_End);
+
+			// Removed blocks leave their filter bits set; clear them now and then.
+			if (m_Removed > window_blocks)
+				RebuildFilter();
+		}
+
+		/**
+		 * Offset of the oldest indexed block equal to the `block_size` bytes
+		 * at `data` with hash `h`, or none.
+		 */
+		size_t Find(uint64_t h, const unsigned char *data) const
+		{
+			// Almost every probe misses; the bit filter answers those from L1.
+			auto f = filter(h);
+			if (!(m_Filter[f / 64] & (uint64_t(1) << (f % 64))))
+				return none;
+			for (auto s = slot(h); m_Slots[s].head != none; s = (s + 1) & mask)
+				if (m_Slots[s].hash == h)
+				{
+					auto offset = m_Origin + m_Slots[s].head * block_size;
+					return std::memcmp(m_Base + offset, data, block_size) ? none : offset;
+				}
+			return none;
+		}
+
+	private:
+		struct Slot
+		{
+			uint64_t hash = 0;
+			size_t head = none; // oldest block with this hash
+			size_t tail = none; // newest
+		};
+
+		static constexpr size_t capacity = window_blocks * 2;
+		static constexpr size_t mask = capacity - 1;
+		static constexpr size_t filter_bits = size_t(1) << 18;
+
+		std::vector<Slot> m_Slots;
+		std::vector<uint64_t> m_Filter;
+		// Per block in the window, by block number modulo window_blocks.
+		std::vector<uint64_t> m_Hashes;
+		std::vector<size_t> m_Next; // next block with the same hash
+		const unsigned char *m_Base = nullptr;
+		size_t m_Origin = 0;
+		size_t m_First = 0; // indexed blocks are [m_First, m_End)
+		size_t m_End = 0;
+		size_t m_Removed = 0;
+
+		static size_t slot(uint64_t h) { return size_t((h ^ (h >> 29)) * 0x9e3779b97f4a7c15ULL >> 32) & mask; }
+		static size_t filter(uint64_t h) { return size_t(h >> 46); }
+
+		void Add(size_t block)
+		{
+			auto h = block_hash(m_Base + m_Origin + block * block_size);
+			m_Hashes[block % window_blocks] = h;
+			m_Next[block % window_blocks] = none;
+
+			auto s = slot(h);
+			while (m_Slots[s].head != none && m_Slots[s].hash != h)
+				s = (s + 1) & mask;
+			if (m_Slots[s].head == none)
+				m_Slots[s] = Slot{h, block, block};
+			else
+			{
+				m_Next[m_Slots[s].tail % window_blocks] = block;
+				m_Slots[s].tail = block;
+			}
+			auto f = filter(h);
+			m_Filter[f / 64] |= uint64_t(1) << (f % 64);
+		}
+
+		/**
+		 * Blocks leave in the order they came, so `block` is the head of its
+		 * list. An emptied slot is filled by shifting the probe run back.
+		 */
+		void Remove(size_t block)
+		{
+			auto h = m_Hashes[block % window_blocks];
+			auto s = slot(h);
+			while (m_Slots[s].hash != h || m_Slots[s].head == none)
+				s = (s + 1) & mask;
+			++m_Removed;
+
+			auto next = m_Next[block % window_blocks];
+			if (next != none)
+			{
+				m_Slots[s].head = next;
+				return;
+			}
+
+			m_Slots[s] = Slot();
+			for (auto i = (s + 1) & mask; m_Slots[i].head != none; i = (i + 1) & mask)
+			{
+				// Move the entry into the hole unless its home lies between them.
+				auto home = slot(m_Slots[i].hash);
+				if (((i - home) & mask) >= ((i - s) & mask))
+				{
+					m_Slots[s] = m_Slots[i];
+					m_Slots[i] = Slot();
+					s = i;
+				}
+			}
+		}
+
+		void RebuildFilter()
+		{
+			std::fill(m_Filter.begin(), m_Filter.end(), 0);
+			for (const auto &slot : m_Slots)
+				if (slot.head != none)
+				{
+					auto f = filter(slot.hash);
+					m_Filter[f / 64] |= uint64_t(1) << (f % 64);
+				}
+			m_Removed = 0;
+		}
+	};
+
+	// Offsets tried on either side by the local resynchronization.
+	const size_t local_reach = 32;
+
+	/**
+	 * Most differences are a few bytes changed, inserted or deleted. Try the
+	 * nearest pairs of offsets first, up to local_reach on either side, and
+	 * accept the first where a whole block agrees again.
+	 */
+	bool resync(const unsigned char *l, size_t lpos, size_t lend, const unsigned char *r, size_t rpos, size_t rend, size_t &lo, size_t &ro)
+	{
+		auto agree = [&](size_t a, size_t b) {
+			return lpos + a + block_size <= lend && rpos + b + block_size <= rend &&
+				   l[lpos + a] == r[rpos + b] && !std::memcmp(l + lpos + a, r + rpos + b, block_size);
+		};
+		for (auto d = size_t(1); d <= local_reach; ++d)
+			for (auto k = size_t(0); k <= d; ++k)
+			{
+				if (agree(k, d))
+					lo = lpos + k, ro = rpos + d;
+				else if (agree(d, k))
+					lo = lpos + d, ro = rpos + k;
+				else
+					continue;
+				return true;
+			}
+		return false;
+	}
+
+	/**
+	 * Find the nearest position after a difference where both sides agree on
+	 * a whole block again. A local resynchronization is tried first; failing
+	 * that, the blocks of the left window are indexed and the right side is
+	 * scanned byte by byte with the rolling hash.
+	 */
+	bool realign(const unsigned char *l, size_t lpos, size_t lend, const unsigned char *r, size_t rpos, size_t rend, BlockIndex &index, size_t &lo, size_t &ro)
+	{
+		if (!resync(l, lpos, lend, r, rpos, rend, lo, ro))
+		{
+			if (lend - lpos < block_size || rend - rpos < block_size)
+				return false;
+			index.Slide(l, lpos, lend);
+
+			auto last = std::min(rend - block_size, rpos + window_size);
+			auto h = block_hash(r + rpos);
+			for (auto p = rpos;; ++p)
+			{
+				auto offset = index.Find(h, r + p);
+				if (offset != BlockIndex::none)
+				{
+					lo = offset;
+					ro = p;
+					break;
+				}
+				if (p == last)
+					return false;
+				h = roll(h, r[p], r[p + block_size]);
+			}
+		}
+
+		// The match starts where a block agrees; the equal bytes before it
+		// belong to it as well.
+		while (lo > lpos && ro > rpos && l[lo - 1] == r[ro - 1])
+			--lo, --ro;
+		return true;
+	}
+
+	/**
+	 * Length of the longest common suffix of two ranges of `size` bytes each
+	 * ending at `l` and `r`.
+	 */
+	size_t common_suffix(const char *l, const char *r, size_t size)
+	{
+		const auto chunk = size_t(4096);
+		auto n = size_t(0);
+		while (n < size)
+		{
+			auto len = std::min(chunk, size - n);
+			auto lp = l - n - len;
+			auto rp = r - n - len;
+			if (PDF::CompareBytes(lp, rp, len).Equal())
+			{
+				n += len;
+				continue;
+			}
+			auto k = len;
+			while (lp[k - 1] == rp[k - 1])
+				--k;
+			return n + len - k;
+		}
+		return n;
+	}
+}
+
+ByteMismatch PDF::CompareBytes(const char *l, const char *r, size_t size, bool count_ranges) noexcept
+{
+	if (!size || l == r)
+		return ByteMismatch();
+	return dispatch().kernel(reinterpret_cast<const unsigned char *>(l), reinterpret_cast<const unsigned char *>(r), size, count_ranges);
+}
+
+const char *PDF::CompareBytesKernel() noexcept { return dispatch().name; }
+
+void PDF::DiffRanges(const char *l, size_t lsize, const char *r, size_t rsize, size_t granularity, const std::function<void(const ByteRange &)> &report)
+{
+	auto pending = ByteRange();
+	auto has_pending = false;
+	auto emit = [&](size_t lo, size_t ln, size_t ro, size_t rn) {
+		if (has_pending)
+		{
+			auto gap = std::max(lo - (pending.left + pending.left_size), ro - (pending.right + pending.right_size));
+			if (gap <= granularity)
+			{
+				pending.left_size = lo + ln - pending.left;
+				pending.right_size = ro + rn - pending.right;
+				return;
+			}
+			report(pending);
+		}
+		pending = ByteRange{lo, ln, ro, rn};
+		has_pending = true;
+	};
+
+	// Cut the common prefix and suffix first; most edits touch one region.
+	auto size = std::min(lsize, rsize);
+	auto prefix = CompareBytes(l, r, size).first;
+	if (prefix == ByteMismatch::npos)
+		prefix = size;
+	auto suffix = common_suffix(l + lsize, r + rsize, size - prefix);
+	auto lend = lsize - suffix;
+	auto rend = rsize - suffix;
+
+	auto lp = reinterpret_cast<const unsigned char *>(l);
+	auto rp = reinterpret_cast<const unsigned char *>(r);
+	auto index = BlockIndex();
+	auto lpos = prefix;
+	auto rpos = prefix;
+	while (lpos < lend || rpos < rend)
+	{
+		auto n = std::min(lend - lpos, rend - rpos);
+		auto same = CompareBytes(l + lpos, r + rpos, n).first;
+		if (same == ByteMismatch::npos)
+			same = n;
+		lpos += same;
+		rpos += same;
+		if (lpos == lend || rpos == rend)
+		{
+			if (lpos < lend || rpos < rend)
+				emit(lpos, lend - lpos, rpos, rend - rpos);
+			break;
+		}
+
+		auto lo = size_t(0);
+		auto ro = size_t(0);
+		if (realign(lp, lpos, lend, rp, rpos, rend, index, lo, ro))
+		{
+			emit(lpos, lo - lpos, rpos, ro - rpos);
+			lpos = lo;
+			rpos = ro;
+		}
+		else
+		{
+			// Nothing in reach matches; take one window of each side as replaced.
+			auto ln = std::min(window_size, lend - lpos);
+			auto rn = std::min(window_size, rend - rpos);
+			emit(lpos, ln, rpos, rn);
+			lpos += ln;
+			rpos += rn;
+		}
+	}
+	if (has_pending)
+		report(pending);
+}
+
+/******************************************************************************
+
+******************************************************************************/
+
+namespace
+{
+	/**
+	 * Linear-space Myers: find the middle snake of the edit graph, split there
+	 * and recurse on both halves.
+	 */
+	class Myers
+	{
+	public:
+		Myers(const hash_t *l, const hash_t *r, size_t max_cost, const std::function<void(const EditRange &)> &report)
+			: m_L(l), m_R(r), m_MaxCost(ptrdiff_t(std::min<size_t>(max_cost, PTRDIFF_MAX / 4))), m_Report(report) {}
+
+		void Run(size_t lsize, size_t rsize)
+		{
+			Diff(0, lsize, 0, rsize);
+			if (m_Pending)
+				m_Report(m_Range);
+		}
+
+	private:
+		const hash_t *m_L;
+		const hash_t *m_R;
+		ptrdiff_t m_MaxCost;
+		const std::function<void(const EditRange &)> &m_Report;
+
+		// Furthest reaching x per diagonal, forward and backward; shared by all levels.
+		std::vector<ptrdiff_t> m_Forward;
+		std::vector<ptrdiff_t> m_Backward;
+
+		EditRange m_Range;
+		bool m_Pending = false;
+
+		bool Equal(size_t i, size_t j) const { return m_L[i] == m_R[j]; }
+
+		// Halves come out in order; runs that touch are merged.
+		void Emit(size_t l0, size_t l1, size_t r0, size_t r1)
+		{
+			if (m_Pending && m_Range.left + m_Range.left_size == l0 && m_Range.right + m_Range.right_size == r0)
+			{
+				m_Range.left_size += l1 - l0;
+				m_Range.right_size += r1 - r0;
+				return;
+			}
+			if (m_Pending)
+				m_Report(m_Range);
+			m_Range = EditRange{l0, l1 - l0, r0, r1 - r0};
+			m_Pending = true;
+		}
+
+		void Diff(size_t l0, size_t l1, size_t r0, size_t r1)
+		{
+			while (l0 < l1 && r0 < r1 && Equal(l0, r0))
+				++l0, ++r0;
+			while (l0 < l1 && r0 < r1 && Equal(l1 - 1, r1 - 1))
+				--l1, --r1;
+			if (l0 == l1 || r0 == r1)
+			{
+				if (l0 < l1 || r0 < r1)
+					Emit(l0, l1, r0, r1);
+				return;
+			}
+			Bisect(l0, l1, r0, r1);
+		}
+
+		void Bisect(size_t l0, size_t l1, size_t r0, size_t r1)
+		{
+			auto n = ptrdiff_t(l1 - l0);
+			auto m = ptrdiff_t(r1 - r0);
+			auto max_d = (n + m + 1) / 2;
+			auto offset = max_d;
+			auto length = 2 * max_d + 2;
+			auto &v1 = m_Forward;
+			auto &v2 = m_Backward;
+			v1.assign(size_t(length), -1);
+			v2.assign(size_t(length), -1);
+			v1[size_t(offset + 1)] = 0;
+			v2[size_t(offset + 1)] = 0;
+
+			// With an odd delta the paths meet on a forward step, otherwise on a backward one.
+			auto delta = n - m;
+			auto front = (delta & 1) != 0;
+			auto k1start = ptrdiff_t(0), k1end = ptrdiff_t(0);
+			auto k2start = ptrdiff_t(0), k2end = ptrdiff_t(0);
+			for (auto d = ptrdiff_t(0); d < max_d && d <= m_MaxCost; ++d)
+			{
+				for (auto k1 = -d + k1start; k1 <= d - k1end; k1 += 2)
+				{
+					auto k1o = offset + k1;
+					auto x1 = k1 == -d || (k1 != d && v1[size_t(k1o - 1)] < v1[size_t(k1o + 1)]) ? v1[size_t(k1o + 1)] : v1[size_t(k1o - 1)] + 1;
+					auto y1 = x1 - k1;
+					while (x1 < n && y1 < m && Equal(l0 + size_t(x1), r0 + size_t(y1)))
+						++x1, ++y1;
+					v1[size_t(k1o)] = x1;
+					if (x1 > n)
+						k1end += 2; // ran off the right of the graph
+					else if (y1 > m)
+						k1start += 2; // ran off the bottom of the graph
+					else if (front)
+					{
+						auto k2o = offset + delta - k1;
+						if (k2o >= 0 && k2o < length && v2[size_t(k2o)] != -1 && x1 >= n - v2[size_t(k2o)])
+							return Split(l0, l1, r0, r1, x1, y1);
+					}
+				}
+
+				for (auto k2 = -d + k2start; k2 <= d - k2end; k2 += 2)
+				{
+					auto k2o = offset + k2;
+					auto x2 = k2 == -d || (k2 != d && v2[size_t(k2o - 1)] < v2[size_t(k2o + 1)]) ? v2[size_t(k2o + 1)] : v2[size_t(k2o - 1)] + 1;
+					auto y2 = x2 - k2;
+					while (x2 < n && y2 < m && Equal(l1 - 1 - size_t(x2), r1 - 1 - size_t(y2)))
+						++x2, ++y2;
+					v2[size_t(k2o)] = x2;
+					if (x2 > n)
+						k2end += 2;
+					else if (y2 > m)
+						k2start += 2;
+					else if (!front)
+					{
+						auto k1o = offset + delta - k2;
+						if (k1o >= 0 && k1o < length && v1[size_t(k1o)] != -1)
+						{
+							auto x1 = v1[size_t(k1o)];
+							auto y1 = offset + x1 - k1o;
+							if (x1 >= n - x2)
+								return Split(l0, l1, r0, r1, x1, y1);
+						}
+					}
+				}
+			}
+
+			// No common operation, or too many differences to be worth finding.
+			Emit(l0, l1, r0, r1);
+		}
+
+		void Split(size_t l0, size_t l1, size_t r0, size_t r1, ptrdiff_t x, ptrdiff_t y)
+		{
+			Diff(l0, l0 + size_t(x), r0, r0 + size_t(y));
+			Diff(l0 + size_t(x), l1, r0 + size_t(y), r1);
+		}
+	};
+}
+
+void PDF::DiffSequences(const hash_t *l, size_t lsize, const hash_t *r, size_t rsize, const std::function<void(const EditRange &)> &report, size_t max_cost)
+{
+	Myers(l, r, max_cost, report).Run(lsize, rsize);
+}
+
+/******************************************************************************
+
+******************************************************************************/
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "pdf_hash.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace PDF
+{
+	/**
+	 * Outcome of comparing two byte ranges of equal size.
+	 */
+	struct ByteMismatch
+	{
+		static constexpr size_t npos = SIZE_MAX;
+
+		size_t first = npos; // offset of the first differing byte
+		size_t ranges = 0;	 // runs of differing bytes; at most 1 unless they were counted
+
+		bool Equal() const noexcept { return !ranges; }
+	};
+
+	/**
+	 * Compare in one vectorized pass (AVX2 or SSE2, picked at run time).
+	 * Without count_ranges it stops at the first difference.
+	 */
+	ByteMismatch CompareBytes(const char *l, const char *r, size_t size, bool count_ranges = false) noexcept;
+
+	/**
+	 * Name of the kernel CompareBytes dispatches to on this CPU.
+	 */
+	const char *CompareBytesKernel() noexcept;
+
+	/**
+	 * A changed region: `left_size` bytes at `left` were replaced by
+	 * `right_size` bytes at `right`. Either size may be zero for a pure
+	 * insertion or deletion.
+	 */
+	struct ByteRange
+	{
+		size_t left = 0;
+		size_t left_size = 0;
+		size_t right = 0;
+		size_t right_size = 0;
+	};
+
+	/**
+	 * Report every changed region between two byte ranges of any size, in
+	 * order. Ranges separated by at most `granularity` equal bytes are
+	 * coalesced into one.
+	 *
+	 * After a difference both sides are realigned, so an insertion or
+	 * deletion is reported as such instead of as a change of everything
+	 * after it: small edits by trying nearby offsets, others with a rolling
+	 * hash over fixed-size blocks (as rsync does). The search only looks
+	 * ahead a bounded window, so memory stays constant however large the
+	 * inputs are; shifts longer than the window come out as a replaced
+	 * region.
+	 */
+	void DiffRanges(const char *l, size_t lsize, const char *r, size_t rsize, size_t granularity, const std::function<void(const ByteRange &)> &report);
+
+	/**
+	 * A changed run between two sequences: `left_size` items from `left` were
+	 * replaced by `right_size` items from `right`.
+	 */
+	struct EditRange
+	{
+		size_t left = 0;
+		size_t left_size = 0;
+		size_t right = 0;
+		size_t right_size = 0;
+	};
+
+	/**
+	 * Shortest edit script between two sequences of item hashes (Myers, in
+	 * linear space), reported as changed runs in order. Sequences that differ
+	 * in more than `max_cost` places are reported partly as one replaced run.
+	 */
+	void DiffSequences(const hash_t *l, size_t lsize, const hash_t *r, size_t rsize, const std::function<void(const EditRange &)> &report, size_t max_cost = 100000);
+}
@@ -0,0 +1,199 @@
+#include "pdf_content.h"
+#include <algorithm>
+#include <ostream>
+
+using namespace PDF;
+
+namespace
+{
+	enum CharClass : uint8_t
+	{
+		Regular,
+		Whitespace,
+		Delimiter,
+	};
+
+	// TABLE 3.1 White-space characters and 3.1.1 delimiters, looked up per byte.
+	struct CharTable
+	{
+		CharClass table[256];
+
+		CharTable()
+		{
+			for (auto &c : table)
+				c = Regular;
+			for (auto ch : std::string_view("\0\t\n\f\r ", 6))
+				table[static_cast<unsigned char>(ch)] = Whitespace;
+			for (auto ch : std::string_view("()<>[]{}/%"))
+				table[static_cast<unsigned char>(ch)] = Delimiter;
+		}
+	};
+
+	const auto char_table = CharTable();
+
+	inline CharClass classify(char ch) { return char_table.table[static_cast<unsigned char>(ch)]; }
+	inline bool is_whitespace(char ch) { return classify(ch) == Whitespace; }
+	inline bool is_regular(char ch) { return classify(ch) == Regular; }
+}
+
+ContentLexer::Token ContentLexer::Next() noexcept
+{
+	auto data = m_Content.data();
+	auto size = m_Content.size();
+	auto token = [&](Kind kind, size_t begin) { return Token{kind, std::string_view(data + begin, m_Pos - begin)}; };
+
+	// 4.8.6 Inline Images: one white-space character follows ID, and the data
+	// runs up to the EI operator.
+	if (m_ImageData)
+	{
+		m_ImageData = false;
+		auto begin = std::min(m_Pos + 1, size);
+		auto end = begin;
+		for (; end + 2 <= size; ++end)
+			if (data[end] == 'E' && data[end + 1] == 'I' && (end == begin || is_whitespace(data[end - 1])) && (end + 2 == size || !is_regular(data[end + 2])))
+				break;
+		m_Pos = std::min(end, size);
+		return token(Kind::InlineImage, begin);
+	}
+
+	// Skip white-space and comments.
+	while (m_Pos < size)
+		if (is_whitespace(data[m_Pos]))
+			++m_Pos;
+		else if (data[m_Pos] == '%')
+			while (m_Pos < size && data[m_Pos] != '\r' && data[m_Pos] != '\n')
+				++m_Pos;
+		else
+			break;
+	if (m_Pos >= size)
+		return Token();
+
+	auto begin = m_Pos;
+	switch (data[m_Pos])
+	{
+	case '(':
+	{
+		// Balanced parentheses; a backslash escapes the next character.
+		auto depth = 0;
+		while (m_Pos < size)
+		{
+			auto ch = data[m_Pos++];
+			if (ch == '\\')
+				++m_Pos;
+			else if (ch == '(')
+				++depth;
+			else if (ch == ')' && --depth == 0)
+				break;
+		}
+		m_Pos = std::min(m_Pos, size);
+		return token(Kind::String, begin);
+	}
+
+	case '<':
+		if (m_Pos + 1 < size && data[m_Pos + 1] == '<')
+		{
+			m_Pos += 2;
+			return token(Kind::DictionaryBegin, begin);
+		}
+		while (m_Pos < size && data[m_Pos] != '>')
+			++m_Pos;
+		m_Pos = std::min(m_Pos + 1, size);
+		return token(Kind::HexString, begin);
+
+	case '>':
+		if (m_Pos + 1 < size && data[m_Pos + 1] == '>')
+		{
+			m_Pos += 2;
+			return token(Kind::DictionaryEnd, begin);
+		}
+		++m_Pos;
+		return token(Kind::Operator, begin);
+
+	case '[':
+		++m_Pos;
+		return token(Kind::ArrayBegin, begin);
+
+	case ']':
+		++m_Pos;
+		return token(Kind::ArrayEnd, begin);
+
+	case '/':
+		++m_Pos;
+		while (m_Pos < size && is_regular(data[m_Pos]))
+			++m_Pos;
+		return token(Kind::Name, begin);
+
+	case ')':
+	case '{':
+	case '}':
+		++m_Pos;
+		return token(Kind::Operator, begin);
+	}
+
+	while (m_Pos < size && is_regular(data[m_Pos]))
+		++m_Pos;
+	auto text = std::string_view(data + begin, m_Pos - begin);
+	if (std::string_view("+-.0123456789").find_first_of(text[0]) != std::string_view::npos)
+		return Token{Kind::Numeric, text};
+	if (text == "true" || text == "false")
+		return Token{Kind::Boolean, text};
+	if (text == "null")
+		return Token{Kind::Null, text};
+	if (text == "ID")
+		m_ImageData = true;
+	return Token{Kind::Operator, text};
+}
+
+operations_t PDF::Tokenize(std::string_view content)
+{
+	auto operations = operations_t();
+	auto lexer = ContentLexer(content);
+	auto first = static_cast<const char *>(nullptr);
+	auto last = static_cast<const char *>(nullptr);
+	auto hash = hash_t(0);
+	for (auto token = lexer.Next(); token.kind != ContentLexer::Kind::End; token = lexer.Next())
+	{
+		if (token.kind != ContentLexer::Kind::Operator)
+		{
+			if (!first)
+				first = token.text.data();
+			last = token.text.data() + token.text.size();
+			hash = HashCombine(hash, HashCombine(hash_t(token.kind), Hash(token.text.data(), token.text.size())));
+			continue;
+		}
+
+		auto operands = first ? std::string_view(first, size_t(last - first)) : std::string_view();
+		operations.push_back(Operation{token.text, operands, HashCombine(hash, Hash(token.text.data(), token.text.size()))});
+		first = last = nullptr;
+		hash = 0;
+	}
+	return operations;
+}
+
+void PDF::DiffOperations(const operations_t &l, const operations_t &r, const std::function<void(const OperationRange &)> &report, size_t max_cost)
+{
+	auto hashes = [](const operations_t &operations) {
+		auto list = std::vector<hash_t>(operations.size());
+		for (auto i = size_t(0); i < operations.size(); ++i)
+			list[i] = operations[i].hash;
+		return list;
+	};
+	auto lh = hashes(l);
+	auto rh = hashes(r);
+	DiffSequences(lh.data(), lh.size(), rh.data(), rh.size(), report, max_cost);
+}
+
+/******************************************************************************
+
+******************************************************************************/
+
+std::ostream &operator<<(std::ostream &out, const PDF::Operation &operation)
+{
+	// Inline image data is binary; only its size is shown.
+	if (operation.op == "EI")
+		out << '[' << operation.operands.size() << " bytes] ";
+	else if (!operation.operands.empty())
+		out << operation.operands << ' ';
+	out << operation.op;
+	return out;
+}
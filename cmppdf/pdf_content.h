@@ -0,0 +1,84 @@
+#pragma once
+
+#include "pdf_compare.h"
+#include "pdf_hash.h"
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+namespace PDF
+{
+	/**
+	 * 3.7.1 Content Streams
+	 *
+	 * Splits decoded content into tokens with the same rules Document::Lex
+	 * applies to objects, but without building objects: every token is a view
+	 * into the content, so nothing is allocated.
+	 */
+	class ContentLexer
+	{
+	public:
+		enum class Kind : uint8_t
+		{
+			End,
+			Numeric,
+			String,
+			HexString,
+			Name,
+			Boolean,
+			Null,
+			ArrayBegin,
+			ArrayEnd,
+			DictionaryBegin,
+			DictionaryEnd,
+			Operator,
+			InlineImage, // binary data between ID and EI
+		};
+
+		struct Token
+		{
+			Kind kind = Kind::End;
+			std::string_view text;
+		};
+
+		explicit ContentLexer(std::string_view content) noexcept : m_Content(content) {}
+
+		/**
+		 * The next token; Kind::End once the content is used up. Malformed
+		 * input never throws, it only ends up in odd tokens.
+		 */
+		Token Next() noexcept;
+
+	private:
+		std::string_view m_Content;
+		size_t m_Pos = 0;
+		bool m_ImageData = false; // the previous token was the ID operator
+	};
+
+	/**
+	 * An operator with its operands (TABLE 4.1 Operator categories).
+	 */
+	struct Operation
+	{
+		std::string_view op;
+		std::string_view operands; // as written, from the first operand to the last
+		hash_t hash = 0;		   // of the tokens, so whitespace and comments do not count
+	};
+	using operations_t = std::vector<Operation>;
+
+	/**
+	 * The operators of a content stream in order; they point into `content`.
+	 */
+	operations_t Tokenize(std::string_view content);
+
+	using OperationRange = EditRange;
+
+	/**
+	 * Shortest edit script between two operator sequences; see DiffSequences.
+	 */
+	void DiffOperations(const operations_t &l, const operations_t &r, const std::function<void(const OperationRange &)> &report, size_t max_cost = 100000);
+}
+
+std::ostream &operator<<(std::ostream &out, const PDF::Operation &operation);
@@ -1,61 +1,88 @@
 #include "pdf_dictionary.h"
 #include "pdf_object.h"
-#include <sstream>
+#include "pdf_printer.h"
+#include "pdf_report.h"
+#include <algorithm>
 
 using namespace PDF;
 
+std::atomic<size_t> Dictionary::s_Copies{0};
+
 struct key_store
 {
-	size_t left = 0, right = 0;
+	name_t key;
+	const Object *left = nullptr, *right = nullptr;
 };
-using keys_t = std::map<name_t, key_store>;
+using keys_t = std::vector<key_store>;
+
+static bool by_text(name_t l, name_t r) { return l != r && l.View() < r.View(); }
 
-keys_t compare(const Dictionary &l, const Dictionary &r)
+/**
+ * Union of the keys of both dictionaries, in id order.
+ */
+static keys_t key_union(const Dictionary &l, const Dictionary &r, std::initializer_list<name_t> ignored)
 {
 	auto keys = keys_t();
-	for (const auto &key : l)
-		++keys[key.first].left;
-	for (const auto &key : r)
-		++keys[key.first].right;
+	auto lit = l.begin();
+	auto rit = r.begin();
+	while (lit != l.end() || rit != r.end())
+		if (rit == r.end() || (lit != l.end() && lit->first < rit->first))
+			keys.push_back({lit->first, &lit->second, nullptr}), ++lit;
+		else if (lit == l.end() || rit->first < lit->first)
+			keys.push_back({rit->first, nullptr, &rit->second}), ++rit;
+		else
+			keys.push_back({lit->first, &lit->second, &rit->second}), ++lit, ++rit;
+	if (ignored.size())
+		keys.erase(std::remove_if(keys.begin(), keys.end(), [&](const key_store &key) { return std::find(ignored.begin(), ignored.end(), key.key) != ignored.end(); }), keys.end());
+	return keys;
+}
+
+/**
+ * Union of the keys of both dictionaries, ordered by key text.
+ */
+static keys_t compare(const Dictionary &l, const Dictionary &r, std::initializer_list<name_t> ignored)
+{
+	auto keys = key_union(l, r, ignored);
+	std::sort(keys.begin(), keys.end(), [](const key_store &a, const key_store &b) { return by_text(a.key, b.key); });
 	return keys;
 }
 
+/**
+ * Different hashes reject at once; equal ones can still collide, so the
+ * entries are compared then. Both sides are ordered by name id.
+ */
 bool Dictionary::operator==(const Dictionary &r) const noexcept
 {
-	if (size() != r.size())
+	if (size() != r.size() || Hash() != r.Hash())
 		return false;
+	return std::equal(begin(), end(), r.begin());
+}
 
-	for (const auto &key : compare(*this, r))
-	{
-		if (!key.second.left || !key.second.right)
-			return false;
-		if (at(key.first) != r.at(key.first))
+bool Dictionary::Equal(const Dictionary &r, std::initializer_list<name_t> ignored) const
+{
+	for (const auto &key : key_union(*this, r, ignored))
+		if (!key.left || !key.right || *key.left != *key.right)
 			return false;
-	}
 	return true;
 }
 
-void Dictionary::diff(std::ostream &out, const Dictionary &r, size_t depth) const noexcept
+void Dictionary::diff(DiffReport &report, const Dictionary &r, size_t depth, std::initializer_list<name_t> ignored) const noexcept
 {
-	for (const auto &key : compare(*this, r))
-		if (!key.second.left)
-			out << std::setw(depth * 4) << ' ' << key.first << ": No key in the left dictionary." << std::endl;
-		else if (!key.second.right)
-			out << std::setw(depth * 4) << ' ' << key.first << ": No key in the right dictionary." << std::endl;
-		else
+	for (const auto &key : compare(*this, r, ignored))
+		if (!key.left)
+			report.Add(DiffRecord::Kind::Note, depth, key.key.View(), "No key in the left dictionary.");
+		else if (!key.right)
+			report.Add(DiffRecord::Kind::Note, depth, key.key.View(), "No key in the right dictionary.");
+		else if (*key.left != *key.right)
 		{
-			auto &lobj = at(key.first);
-			auto &robj = r.at(key.first);
-			if (lobj != robj)
-			{
-				out << std::setw(depth * 4) << ' ' << key.first << ":" << std::endl;
-				lobj.diff(out, robj, depth + 1);
-			}
+			report.Add(DiffRecord::Kind::Group, depth, key.key.View());
+			key.left->diff(report, *key.right, depth + 1);
 		}
 }
 
 void Dictionary::Merge(const Dictionary &r)
 {
+	m_Hash.Reset();
 	for (const auto &rv : r)
 	{
 		auto lit = find(rv.first);
@@ -66,18 +93,64 @@ void Dictionary::Merge(const Dictionary &r)
 	}
 }
 
-bool Dictionary::HasKey(const char *key) const { return find(key) != end(); }
+bool Dictionary::HasKey(name_t key) const { return find(key) != end(); }
 const Object &Dictionary::operator[](const Dictionary::key_type &key) const { return at(key); }
-Object &Dictionary::operator[](const Dictionary::key_type &key) { return dictionary_parent_t::operator[](key); }
+Object &Dictionary::operator[](const Dictionary::key_type &key)
+{
+	m_Hash.Reset();
+	return dictionary_parent_t::operator[](key);
+}
 
-std::string Dictionary::Display() const noexcept
+/**
+ * The entry hashes are combined in sorted order, so the result does not depend
+ * on the id order of the keys. A sum would not either, but entries could
+ * cancel each other out in it.
+ */
+static hash_t combine_entries(std::vector<hash_t> &entries)
+{
+	std::sort(entries.begin(), entries.end());
+	auto h = HashCombine(0, entries.size());
+	for (auto entry : entries)
+		h = HashCombine(h, entry);
+	return h;
+}
+
+hash_t Dictionary::Hash() const
 {
-	auto s = std::stringstream();
-	s << "<<";
+	return m_Hash.Get([this] {
+		auto entries = std::vector<hash_t>();
+		entries.reserve(size());
+		for (const auto &item : *this)
+			entries.push_back(HashCombine(item.first.Hash(), item.second.Hash()));
+		return combine_entries(entries);
+	});
+}
+
+hash_t Dictionary::Hash(std::initializer_list<name_t> ignored) const
+{
+	auto entries = std::vector<hash_t>();
+	entries.reserve(size());
 	for (const auto &item : *this)
-		s << "/" << item.first << " " << item.second.Display() << " ";
-	s << ">>";
-	return s.str();
+		if (std::find(ignored.begin(), ignored.end(), item.first) == ignored.end())
+			entries.push_back(HashCombine(item.first.Hash(), item.second.Hash()));
+	return combine_entries(entries);
+}
+
+std::vector<const Dictionary::value_type *> Dictionary::Sorted() const
+{
+	auto items = std::vector<const value_type *>();
+	items.reserve(size());
+	for (const auto &item : *this)
+		items.push_back(&item);
+	std::sort(items.begin(), items.end(), [](const value_type *a, const value_type *b) { return by_text(a->first, b->first); });
+	return items;
+}
+
+std::string Dictionary::Display() const noexcept
+{
+	auto s = std::string();
+	Printer(s).Print(*this);
+	return s;
 }
 
 /******************************************************************************
@@ -86,15 +159,7 @@ std::string Dictionary::Display() const noexcept
 
 std::ostream &operator<<(std::ostream &out, const PDF::Dictionary &dic)
 {
-	if (dic.HasKey("Type"))
-		out << dic["Type"].GetName() << ": " << dic.Display();
-	else if (dic.HasKey("Font"))
-		out << "Font: " << dic.Display();
-	else if (dic.HasKey("CreationDate") || dic.HasKey("ModDate") || dic.HasKey("Producer"))
-		out << "Info: " << dic.Display();
-	else if (dic.HasKey("Length"))
-		out << "Stream?: " << dic.Display();
-	else
-		out << "*: " << dic.Display();
-	return out;
+	auto s = std::string();
+	Printer(s).Summary(dic);
+	return out << s;
 }
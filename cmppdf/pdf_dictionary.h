@@ -1,31 +1,83 @@
 #pragma once
 
+#include "pdf_arena.h"
+#include "pdf_hash.h"
+#include "pdf_name.h"
+#include <initializer_list>
 #include <ostream>
 #include <map>
 #include <string>
+#include <vector>
 
 namespace PDF
 {
 	class Object;
-	using name_t = std::string;
-	using dictionary_parent_t = std::map<name_t, Object>;
+	class DiffReport;
+	using name_t = Name;
+	using dictionary_parent_t = std::pmr::map<name_t, Object>;
 
 	class Dictionary : public dictionary_parent_t
 	{
 	public:
+		Dictionary() : dictionary_parent_t(Arena::Current()) {}
+		Dictionary(const Dictionary &r) : dictionary_parent_t(r, Arena::Current()), m_Hash(r.m_Hash) { ++s_Copies; }
+		Dictionary(Dictionary &&r) = default;
 		virtual ~Dictionary() = default;
 
+		Dictionary &operator=(const Dictionary &r)
+		{
+			++s_Copies;
+			dictionary_parent_t::operator=(r);
+			m_Hash = r.m_Hash;
+			return *this;
+		}
+		Dictionary &operator=(Dictionary &&r) = default;
+
 		bool operator==(const Dictionary &r) const noexcept;
 		bool operator!=(const Dictionary &r) const noexcept { return !(*this == r); }
-		void diff(std::ostream &out, const Dictionary &r, size_t depth = 0) const noexcept;
+		void diff(DiffReport &report, const Dictionary &r, size_t depth = 0, std::initializer_list<name_t> ignored = {}) const noexcept;
+
+		/**
+		 * Equality that skips the `ignored` keys on both sides, e.g. the ones
+		 * that only describe how a stream is encoded.
+		 */
+		bool Equal(const Dictionary &r, std::initializer_list<name_t> ignored) const;
+
+		/**
+		 * Structural hash of the entries, independent of their order; computed
+		 * on first use and dropped by any mutable access.
+		 */
+		hash_t Hash() const;
+
+		/**
+		 * Hash that skips the `ignored` keys, matching Equal; not cached.
+		 */
+		hash_t Hash(std::initializer_list<name_t> ignored) const;
 
 		void Merge(const Dictionary &r);
 
-		bool HasKey(const char *key) const;
+		bool HasKey(name_t key) const;
 		const Object &operator[](const Dictionary::key_type &key) const;
 		Object &operator[](const Dictionary::key_type &key);
 
+		/**
+		 * Entries ordered by key text. The container itself is ordered by name
+		 * id, which depends on the order names were interned.
+		 */
+		std::vector<const value_type *> Sorted() const;
+
 		std::string Display() const noexcept;
+
+		/**
+		 * Deep copies made so far, by all threads. Parsing and traversal only
+		 * move containers, so this stays zero unless a caller copies one.
+		 */
+		static size_t GetCopies() noexcept { return s_Copies; }
+
+	private:
+		static std::atomic<size_t> s_Copies;
+
+		HashCache m_Hash;
 	};
 }
 
@@ -0,0 +1,545 @@
+#include "pdf_filter.h"
+#include "pdf_except.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <zlib.h>
+
+using namespace PDF;
+
+namespace
+{
+	const size_t chunk_size = 16384;
+
+	bool is_whitespace(int c) { return c == 0 || c == '\t' || c == '\n' || c == '\f' || c == '\r' || c == ' '; }
+
+	/**
+	 * The raw stream bytes.
+	 */
+	class Source : public Decoder
+	{
+	public:
+		Source(const char *data, size_t size) : m_Data(data), m_Size(size) {}
+
+	protected:
+		size_t Fill(char *buffer, size_t size) override
+		{
+			auto n = std::min(size, m_Size);
+			std::memcpy(buffer, m_Data, n);
+			m_Data += n;
+			m_Size -= n;
+			return n;
+		}
+
+	private:
+		const char *m_Data;
+		size_t m_Size;
+	};
+
+	/**
+	 * A filter reading its input from the previous stage through a chunk buffer.
+	 */
+	class Stage : public Decoder
+	{
+	protected:
+		explicit Stage(std::unique_ptr<Decoder> source) : m_Source(std::move(source)) {}
+
+		// The next input byte, or -1 at the end of the input.
+		int Next()
+		{
+			if (m_Pos == m_Size)
+			{
+				m_Size = m_Source->Read(m_Input, sizeof(m_Input));
+				m_Pos = 0;
+				if (!m_Size)
+					return -1;
+			}
+			return static_cast<unsigned char>(m_Input[m_Pos++]);
+		}
+
+		std::unique_ptr<Decoder> m_Source;
+		char m_Input[chunk_size];
+		size_t m_Pos = 0;
+		size_t m_Size = 0;
+		bool m_End = false;
+	};
+
+	/**
+	 * 3.3.3 LZWDecode and FlateDecode Filters
+	 */
+	class FlateDecoder : public Stage
+	{
+	public:
+		explicit FlateDecoder(std::unique_ptr<Decoder> source) : Stage(std::move(source))
+		{
+			if (inflateInit(&m_Z) != Z_OK)
+				throw parse_error("Failed initialize zlib.");
+		}
+		~FlateDecoder() override { inflateEnd(&m_Z); }
+
+	protected:
+		size_t Fill(char *buffer, size_t size) override
+		{
+			if (m_End)
+				return 0;
+
+			// zlib counts in uInt, so hand out very large buffers piecewise.
+			m_Z.next_out = reinterpret_cast<Bytef *>(buffer);
+			m_Z.avail_out = uInt(std::min<size_t>(size, UINT_MAX));
+			auto capacity = m_Z.avail_out;
+			while (m_Z.avail_out)
+			{
+				if (!m_Z.avail_in && !m_InputEnd)
+				{
+					m_Z.next_in = reinterpret_cast<Bytef *>(m_Input);
+					m_Z.avail_in = uInt(m_Source->Read(m_Input, sizeof(m_Input)));
+					m_InputEnd = !m_Z.avail_in;
+				}
+				auto ret = inflate(&m_Z, Z_NO_FLUSH);
+				if (ret == Z_STREAM_END)
+				{
+					m_End = true;
+					break;
+				}
+				if (ret != Z_OK && ret != Z_BUF_ERROR)
+					throw parse_error("Failed FlateDecode.");
+				// A truncated stream stops making progress; keep what was decoded.
+				if (ret == Z_BUF_ERROR && !m_Z.avail_in && m_InputEnd)
+				{
+					m_End = true;
+					break;
+				}
+			}
+			return capacity - m_Z.avail_out;
+		}
+
+	private:
+		z_stream m_Z = z_stream();
+		bool m_InputEnd = false;
+	};
+
+	/**
+	 * 3.3.1 ASCIIHexDecode Filter
+	 */
+	class ASCIIHexDecoder : public Stage
+	{
+	public:
+		explicit ASCIIHexDecoder(std::unique_ptr<Decoder> source) : Stage(std::move(source)) {}
+
+	protected:
+		size_t Fill(char *buffer, size_t size) override
+		{
+			auto n = size_t(0);
+			while (n < size && !m_End)
+			{
+				auto c = Next();
+				if (c < 0 || c == '>')
+				{
+					// An odd final digit is followed by an implicit 0.
+					if (m_Half)
+						buffer[n++] = char(m_High << 4);
+					m_End = true;
+					break;
+				}
+				if (is_whitespace(c))
+					continue;
+				auto digit = hex(c);
+				if (digit < 0)
+					throw parse_error("Invalid ASCIIHexDecode data.");
+				if (m_Half)
+					buffer[n++] = char(m_High << 4 | digit);
+				else
+					m_High = digit;
+				m_Half = !m_Half;
+			}
+			return n;
+		}
+
+	private:
+		int m_High = 0;
+		bool m_Half = false;
+
+		static int hex(int c)
+		{
+			if (c >= '0' && c <= '9')
+				return c - '0';
+			if (c >= 'a' && c <= 'f')
+				return c - 'a' + 10;
+			if (c >= 'A' && c <= 'F')
+				return c - 'A' + 10;
+			return -1;
+		}
+	};
+
+	/**
+	 * 3.3.2 ASCII85Decode Filter
+	 */
+	class ASCII85Decoder : public Stage
+	{
+	public:
+		explicit ASCII85Decoder(std::unique_ptr<Decoder> source) : Stage(std::move(source)) {}
+
+	protected:
+		size_t Fill(char *buffer, size_t size) override
+		{
+			auto n = size_t(0);
+			while (n < size)
+			{
+				if (m_OutPos < m_OutSize)
+					buffer[n++] = char(m_Out[m_OutPos++]);
+				else if (m_End)
+					break;
+				else
+					Group();
+			}
+			return n;
+		}
+
+	private:
+		unsigned char m_Out[4];
+		size_t m_OutPos = 0;
+		size_t m_OutSize = 0;
+
+		// Decode the next group of five characters into up to four bytes.
+		void Group()
+		{
+			m_OutPos = m_OutSize = 0;
+			auto value = uint64_t(0);
+			auto count = 0;
+			while (count < 5)
+			{
+				auto c = Next();
+				if (c < 0 || c == '~')
+				{
+					// '~>' is the EOD marker; a missing one is tolerated.
+					m_End = true;
+					break;
+				}
+				if (is_whitespace(c))
+					continue;
+				if (c == 'z' && !count)
+				{
+					std::memset(m_Out, 0, 4);
+					m_OutSize = 4;
+					return;
+				}
+				if (c < '!' || c > 'u')
+					throw parse_error("Invalid ASCII85Decode data.");
+				value = value * 85 + uint64_t(c - '!');
+				++count;
+			}
+			if (!count)
+				return;
+			if (count == 1)
+				throw parse_error("Invalid ASCII85Decode final group.");
+
+			// A final group of n characters is padded with 'u' and yields n - 1 bytes.
+			for (auto i = count; i < 5; ++i)
+				value = value * 85 + 84;
+			if (value > UINT32_MAX)
+				throw parse_error("Invalid ASCII85Decode group.");
+			for (auto i = 0; i < 4; ++i)
+				m_Out[i] = static_cast<unsigned char>(value >> (24 - i * 8));
+			m_OutSize = size_t(count - 1);
+		}
+	};
+
+	/**
+	 * 3.3.4 RunLengthDecode Filter
+	 */
+	class RunLengthDecoder : public Stage
+	{
+	public:
+		explicit RunLengthDecoder(std::unique_ptr<Decoder> source) : Stage(std::move(source)) {}
+
+	protected:
+		size_t Fill(char *buffer, size_t size) override
+		{
+			auto n = size_t(0);
+			while (n < size)
+			{
+				if (m_Repeat)
+				{
+					auto k = std::min(m_Repeat, size - n);
+					std::memset(buffer + n, m_Byte, k);
+					n += k;
+					m_Repeat -= k;
+				}
+				else if (m_Copy)
+				{
+					auto c = Next();
+					if (c < 0)
+					{
+						m_Copy = 0;
+						m_End = true;
+						break;
+					}
+					buffer[n++] = char(c);
+					--m_Copy;
+				}
+				else if (m_End)
+					break;
+				else
+				{
+					// 0-127: copy length + 1 bytes, 129-255: repeat the next byte 257 - length times, 128: EOD
+					auto length = Next();
+					if (length < 0 || length == 128)
+						m_End = true;
+					else if (length < 128)
+						m_Copy = size_t(length) + 1;
+					else
+					{
+						m_Byte = Next();
+						if (m_Byte < 0)
+							m_End = true;
+						else
+							m_Repeat = size_t(257 - length);
+					}
+				}
+			}
+			return n;
+		}
+
+	private:
+		size_t m_Copy = 0;
+		size_t m_Repeat = 0;
+		int m_Byte = 0;
+	};
+
+	Object resolved(const Object &obj, const resolver_t &resolve)
+	{
+		if (obj != Object::Type::INDIRECT)
+			return obj;
+		if (!resolve)
+			throw type_error("Indirect filter entry.");
+		return resolve(obj);
+	}
+
+	int get_parameter(const Object &parms, Name key, int def, const resolver_t &resolve)
+	{
+		if (parms != Object::Type::DICTIONARY || !parms.HasKey(key))
+			return def;
+		auto value = resolved(parms[key], resolve);
+		if (value != Object::Type::NUMERIC)
+			throw type_error("Filter parameter must be a number.");
+		return int(value.GetNumeric());
+	}
+
+	/**
+	 * TABLE 3.8 Optional parameters for LZWDecode and FlateDecode filters
+	 */
+	class PredictorDecoder : public Decoder
+	{
+	public:
+		PredictorDecoder(std::unique_ptr<Decoder> source, const Object &parms, const resolver_t &resolve) : m_Source(std::move(source))
+		{
+			m_Predictor = get_parameter(parms, Name::Predictor, 1, resolve);
+			auto colors = get_parameter(parms, Name::Colors, 1, resolve);
+			auto bpc = get_parameter(parms, Name::BitsPerComponent, 8, resolve);
+			auto columns = get_parameter(parms, Name::Columns, 1, resolve);
+			if (colors < 1 || bpc < 1 || columns < 1)
+				throw parse_error("Invalid predictor parameters.");
+			if (m_Predictor == 2 && bpc != 8)
+				throw parse_error("Unsupported TIFF predictor depth.");
+			m_Bpp = size_t(std::max(1, colors * bpc / 8));
+			m_Row = (size_t(columns) * size_t(colors) * size_t(bpc) + 7) / 8;
+			m_Prior.resize(m_Row);
+			m_Current.resize(m_Row);
+			m_Line.resize(m_Row + 1);
+		}
+
+	protected:
+		size_t Fill(char *buffer, size_t size) override
+		{
+			auto n = size_t(0);
+			while (n < size)
+			{
+				if (m_Pos < m_Avail)
+				{
+					auto k = std::min(m_Avail - m_Pos, size - n);
+					std::memcpy(buffer + n, m_Current.data() + m_Pos, k);
+					m_Pos += k;
+					n += k;
+				}
+				else if (m_End)
+					break;
+				else if (m_Predictor == 2)
+					TiffRow();
+				else
+					PngRow();
+			}
+			return n;
+		}
+
+	private:
+		std::unique_ptr<Decoder> m_Source;
+		int m_Predictor;
+		size_t m_Bpp;
+		size_t m_Row;
+		std::vector<unsigned char> m_Prior;
+		std::vector<unsigned char> m_Current;
+		std::vector<unsigned char> m_Line;
+		size_t m_Pos = 0;
+		size_t m_Avail = 0;
+		bool m_End = false;
+
+		// TIFF Predictor 2; a partial last row is passed through.
+		void TiffRow()
+		{
+			m_Pos = 0;
+			m_Avail = m_Source->Read(reinterpret_cast<char *>(m_Current.data()), m_Row);
+			if (m_Avail < m_Row)
+			{
+				m_End = true;
+				return;
+			}
+			for (auto i = m_Bpp; i < m_Row; ++i)
+				m_Current[i] = static_cast<unsigned char>(m_Current[i] + m_Current[i - m_Bpp]);
+		}
+
+		// PNG predictors: every row is prefixed by its filter type. A partial last row is dropped.
+		void PngRow()
+		{
+			m_Pos = m_Avail = 0;
+			if (m_Source->Read(reinterpret_cast<char *>(m_Line.data()), m_Line.size()) < m_Line.size())
+			{
+				m_End = true;
+				return;
+			}
+			m_Prior.swap(m_Current);
+
+			auto type = m_Line[0];
+			auto src = m_Line.data() + 1;
+			for (auto i = size_t(0); i < m_Row; ++i)
+			{
+				auto left = i >= m_Bpp ? m_Current[i - m_Bpp] : 0;
+				auto up = m_Prior[i];
+				auto up_left = i >= m_Bpp ? m_Prior[i - m_Bpp] : 0;
+				switch (type)
+				{
+				case 0:
+					m_Current[i] = src[i];
+					break;
+				case 1:
+					m_Current[i] = src[i] + left;
+					break;
+				case 2:
+					m_Current[i] = src[i] + up;
+					break;
+				case 3:
+					m_Current[i] = src[i] + (left + up) / 2;
+					break;
+				case 4:
+				{
+					auto pa = std::abs(up - up_left);
+					auto pb = std::abs(left - up_left);
+					auto pc = std::abs(left + up - 2 * up_left);
+					m_Current[i] = src[i] + (pa <= pb && pa <= pc ? left : pb <= pc ? up : up_left);
+					break;
+				}
+				default:
+					throw parse_error("Unknown PNG predictor.");
+				}
+			}
+			m_Avail = m_Row;
+		}
+	};
+}
+
+size_t Decoder::Read(char *buffer, size_t size)
+{
+	auto n = size_t(0);
+	while (n < size)
+	{
+		auto got = Fill(buffer + n, size - n);
+		if (!got)
+			break;
+		n += got;
+	}
+	return n;
+}
+
+/**
+ * TABLE 3.5 Standard filters
+ */
+std::unique_ptr<Decoder> PDF::OpenDecoder(const Object &dictionary, const Stream &stream, bool partial, const resolver_t &resolve)
+{
+	auto decoder = std::unique_ptr<Decoder>(std::make_unique<Source>(stream.GetData(), stream.GetSize()));
+	if (!dictionary.HasKey(Name::Filter))
+		return decoder;
+
+	// Filter and DecodeParms are either single entries or parallel arrays.
+	auto filter = resolved(dictionary[Name::Filter], resolve);
+	auto parms = dictionary.HasKey(Name::DecodeParms) ? resolved(dictionary[Name::DecodeParms], resolve) : Object();
+	auto entry = [](const Object &obj, size_t i) {
+		if (obj != Object::Type::ARRAY)
+			return i ? Object() : obj;
+		const auto &array = obj.GetArray();
+		return i < array.size() ? array[i] : Object();
+	};
+	auto count = filter == Object::Type::ARRAY ? filter.GetArray().size() : 1;
+
+	for (auto i = size_t(0); i < count; ++i)
+	{
+		auto obj = resolved(entry(filter, i), resolve);
+		if (obj != Object::Type::NAME)
+			throw type_error("Filter must be a name.");
+		auto name = obj.GetName();
+		auto parm = resolved(entry(parms, i), resolve);
+		if (name == Name::FlateDecode || name == Name::Fl)
+		{
+			decoder = std::make_unique<FlateDecoder>(std::move(decoder));
+			if (get_parameter(parm, Name::Predictor, 1, resolve) >= 2)
+				decoder = std::make_unique<PredictorDecoder>(std::move(decoder), parm, resolve);
+		}
+		else if (name == Name::ASCIIHexDecode || name == Name::AHx)
+			decoder = std::make_unique<ASCIIHexDecoder>(std::move(decoder));
+		else if (name == Name::ASCII85Decode || name == Name::A85)
+			decoder = std::make_unique<ASCII85Decoder>(std::move(decoder));
+		else if (name == Name::RunLengthDecode || name == Name::RL)
+			decoder = std::make_unique<RunLengthDecoder>(std::move(decoder));
+		else if (partial)
+			break;
+		else
+			throw parse_error("Unsupported filter: " + std::string(name.View()));
+	}
+	return decoder;
+}
+
+decoded_t PDF::Decode(const Object &dictionary, const Stream &stream, bool partial, const resolver_t &resolve)
+{
+	auto decoder = OpenDecoder(dictionary, stream, partial, resolve);
+	auto data = decoded_t();
+	char buffer[chunk_size];
+	while (auto n = decoder->Read(buffer, sizeof(buffer)))
+		data.insert(data.end(), buffer, buffer + n);
+	return data;
+}
+
+DecodedMismatch PDF::CompareDecoded(Decoder &l, Decoder &r, bool count_sizes)
+{
+	auto result = DecodedMismatch();
+	char lbuffer[chunk_size];
+	char rbuffer[chunk_size];
+	while (true)
+	{
+		auto ln = l.Read(lbuffer, sizeof(lbuffer));
+		auto rn = r.Read(rbuffer, sizeof(rbuffer));
+		if (result.Equal())
+		{
+			// Both sides are at the same offset until the first difference.
+			auto n = std::min(ln, rn);
+			auto mismatch = CompareBytes(lbuffer, rbuffer, n);
+			if (!mismatch.Equal())
+				result.first = result.left_size + mismatch.first;
+			else if (ln != rn)
+				result.first = result.left_size + n;
+		}
+		result.left_size += ln;
+		result.right_size += rn;
+		if ((ln < sizeof(lbuffer) && rn < sizeof(rbuffer)) || (!result.Equal() && !count_sizes))
+			break;
+	}
+	return result;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "pdf_compare.h"
+#include "pdf_object.h"
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+namespace PDF
+{
+	using decoded_t = std::vector<char>;
+
+	/**
+	 * TABLE 3.4 Entries common to all stream dictionaries, the ones that only
+	 * describe how the data is encoded.
+	 */
+	inline const std::initializer_list<Name> EncodingKeys = {Name::Length, Name::Filter, Name::DecodeParms, Name::DL};
+
+	/**
+	 * One stage of a filter pipeline. Every stage pulls fixed-size chunks from
+	 * the one before it, so a stream is never decoded in full unless the caller
+	 * asks for it.
+	 */
+	class Decoder
+	{
+	public:
+		virtual ~Decoder() = default;
+
+		/**
+		 * Decode up to `size` bytes into `buffer`. Less is returned only at the
+		 * end of the data, and 0 after it.
+		 */
+		size_t Read(char *buffer, size_t size);
+
+	protected:
+		// Produce at least one byte unless the data has ended.
+		virtual size_t Fill(char *buffer, size_t size) = 0;
+	};
+
+	/**
+	 * The object an indirect reference stands for. /Filter, /DecodeParms and
+	 * their entries may be indirect references (TABLE 3.4); without a
+	 * resolver they are type errors.
+	 */
+	using resolver_t = std::function<Object(const Object &)>;
+
+	/**
+	 * Build the pipeline for the /Filter chain of a stream dictionary (with its
+	 * /DecodeParms). Supported are FlateDecode with TIFF and PNG predictors,
+	 * ASCIIHexDecode, ASCII85Decode and RunLengthDecode. An unsupported filter
+	 * throws parse_error, or with `partial` ends the chain there so that the
+	 * still encoded bytes come out. A filter entry that is not a name throws
+	 * type_error.
+	 */
+	std::unique_ptr<Decoder> OpenDecoder(const Object &dictionary, const Stream &stream, bool partial = false, const resolver_t &resolve = nullptr);
+
+	/**
+	 * Apply the /Filter chain of a stream dictionary (with its /DecodeParms) to the raw stream bytes.
+	 */
+	decoded_t Decode(const Object &dictionary, const Stream &stream, bool partial = false, const resolver_t &resolve = nullptr);
+
+	/**
+	 * Outcome of comparing two decoded streams.
+	 */
+	struct DecodedMismatch
+	{
+		size_t first = ByteMismatch::npos; // decoded offset of the first difference
+		size_t left_size = 0;			   // decoded sizes; complete only if they were counted
+		size_t right_size = 0;
+
+		bool Equal() const noexcept { return first == ByteMismatch::npos; }
+	};
+
+	/**
+	 * Compare two pipelines chunk by chunk. Without count_sizes it stops at the
+	 * first difference.
+	 */
+	DecodedMismatch CompareDecoded(Decoder &l, Decoder &r, bool count_sizes = false);
+}
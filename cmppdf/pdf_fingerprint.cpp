@@ -0,0 +1,155 @@
+#include "pdf_fingerprint.h"
+#include "file_image.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+using namespace PDF;
+
+namespace
+{
+	const char magic[8] = {'C', 'M', 'P', 'P', 'D', 'F', 'F', 'P'};
+	const uint32_t format = 1;
+
+	// Fingerprints of real documents are far below this; anything larger is damage.
+	const uint64_t max_objects = uint64_t(1) << 32;
+
+	template <typename T>
+	void put(std::ostream &out, const T &value) { out.write(reinterpret_cast<const char *>(&value), sizeof(value)); }
+
+	template <typename T>
+	bool get(std::istream &in, T &value) { return bool(in.read(reinterpret_cast<char *>(&value), sizeof(value))); }
+
+	bool file_status(const std::string &name, uint64_t &size, int64_t &time)
+	{
+		auto error = std::error_code();
+		size = std::filesystem::file_size(name, error);
+		if (error)
+			return false;
+		time = std::filesystem::last_write_time(name, error).time_since_epoch().count();
+		return !error;
+	}
+}
+
+bool Fingerprint::operator==(const Fingerprint &r) const
+{
+	return decoded == r.decoded && version == r.version && trailer_size == r.trailer_size &&
+		   root == r.root && info == r.info && objects == r.objects;
+}
+
+bool Fingerprint::Write(const std::string &name) const
+{
+	auto out = std::ofstream(name, std::ios::binary | std::ios::trunc);
+	out.write(magic, sizeof(magic));
+	put(out, format);
+	put(out, file_size);
+	put(out, file_time);
+	put(out, file_hash);
+	put(out, uint8_t(decoded));
+	put(out, uint64_t(version.size()));
+	out.write(version.data(), version.size());
+	put(out, uint64_t(trailer_size));
+	put(out, root);
+	put(out, info);
+	put(out, uint64_t(objects.size()));
+	out.write(reinterpret_cast<const char *>(objects.data()), objects.size() * sizeof(hash_t));
+	return bool(out.flush());
+}
+
+std::optional<Fingerprint> Fingerprint::Read(const std::string &name)
+{
+	auto in = std::ifstream(name, std::ios::binary);
+	char head[sizeof(magic)];
+	auto version = uint32_t(0);
+	if (!in.read(head, sizeof(head)) || std::memcmp(head, magic, sizeof(magic)) || !get(in, version) || version != format)
+		return std::nullopt;
+
+	auto fp = Fingerprint();
+	auto decoded = uint8_t(0);
+	auto size = uint64_t(0);
+	if (!get(in, fp.file_size) || !get(in, fp.file_time) || !get(in, fp.file_hash) || !get(in, decoded) || !get(in, size) || size > 64)
+		return std::nullopt;
+	fp.decoded = decoded != 0;
+	fp.version.resize(size);
+	if (!in.read(fp.version.data(), size))
+		return std::nullopt;
+
+	auto trailer_size = uint64_t(0);
+	if (!get(in, trailer_size) || !get(in, fp.root) || !get(in, fp.info) || !get(in, size) || size > max_objects)
+		return std::nullopt;
+	fp.trailer_size = trailer_size;
+	fp.objects.resize(size);
+	if (!in.read(reinterpret_cast<char *>(fp.objects.data()), size * sizeof(hash_t)) || in.peek() != std::char_traits<char>::eof())
+		return std::nullopt;
+	return fp;
+}
+
+/******************************************************************************
+
+******************************************************************************/
+
+/**
+ * Named after the hash of the absolute path, so that a golden file is found
+ * again from any working directory.
+ */
+std::string FingerprintCache::GetPath(const std::string &name, bool decoded) const
+{
+	auto error = std::error_code();
+	auto path = std::filesystem::absolute(name, error).string();
+	if (error)
+		path = name;
+
+	auto out = std::ostringstream();
+	out << std::hex << std::setfill('0') << std::setw(16) << Hash(path.data(), path.size()) << (decoded ? ".decoded.fp" : ".fp");
+	return (std::filesystem::path(m_Directory) / out.str()).string();
+}
+
+std::optional<Fingerprint> FingerprintCache::Find(const std::string &name, bool decoded) const
+{
+	auto path = GetPath(name, decoded);
+	auto fp = Fingerprint::Read(path);
+	auto size = uint64_t(0);
+	auto time = int64_t(0);
+	if (!fp || fp->decoded != decoded || !file_status(name, size, time) || fp->file_size != size)
+		return std::nullopt;
+	if (fp->file_time == time)
+		return fp;
+
+	// Touched but maybe not changed.
+	try
+	{
+		auto image = FileImage(name);
+		if (Hash(image.Data(), image.Size()) != fp->file_hash)
+			return std::nullopt;
+	}
+	catch (const std::exception &)
+	{
+		return std::nullopt;
+	}
+	fp->file_time = time;
+	Store(name, *fp);
+	return fp;
+}
+
+void FingerprintCache::Store(const std::string &name, Fingerprint fingerprint) const
+{
+	// A file that changed since it was loaded is left alone.
+	auto size = uint64_t(0);
+	if (!file_status(name, size, fingerprint.file_time) || size != fingerprint.file_size)
+		return;
+
+	// Written aside and renamed, so that readers never see half a file.
+	auto path = GetPath(name, fingerprint.decoded);
+	auto temp = path + "." + std::to_string(std::random_device()()) + ".tmp";
+	auto error = std::error_code();
+	std::filesystem::create_directories(m_Directory, error);
+	if (fingerprint.Write(temp))
+		std::filesystem::rename(temp, path, error);
+	else
+		error = std::make_error_code(std::errc::io_error);
+	if (error)
+		std::filesystem::remove(temp, error);
+}
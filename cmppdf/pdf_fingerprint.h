@@ -0,0 +1,71 @@
+#pragma once
+
+#include "pdf_hash.h"
+#include "pdf_report.h"
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace PDF
+{
+	/**
+	 * Everything Document::operator== looks at, reduced to hashes: the
+	 * version, the trailer and one structural hash per xref entry. Comparing
+	 * against it needs neither the file nor its objects.
+	 */
+	struct Fingerprint
+	{
+		// Identity of the source file, used as the cache key.
+		uint64_t file_size = 0;
+		int64_t file_time = 0;
+		hash_t file_hash = 0;
+
+		// Entry hashes follow Xref::Equal with `decoded`.
+		bool decoded = false;
+
+		std::string version;
+		size_t trailer_size = 0;
+		hash_t root = 0;
+		hash_t info = 0;
+		std::vector<hash_t> objects; // by object number
+
+		// Same document; the file identity does not count.
+		bool operator==(const Fingerprint &r) const;
+		bool operator!=(const Fingerprint &r) const { return !(*this == r); }
+
+		/**
+		 * A compact binary file in host byte order; it is a local cache,
+		 * not an exchange format. Read returns nothing for a missing,
+		 * foreign or damaged file.
+		 */
+		bool Write(const std::string &name) const;
+		static std::optional<Fingerprint> Read(const std::string &name);
+	};
+
+	/**
+	 * Fingerprints of source files kept in a directory, one file each.
+	 *
+	 * An entry is valid while the size and modification time of its source
+	 * are unchanged; then only the fingerprint is read. If just the time
+	 * changed, e.g. after a fresh checkout, the content hash decides.
+	 */
+	class FingerprintCache
+	{
+	public:
+		explicit FingerprintCache(std::string directory) : m_Directory(std::move(directory)) {}
+
+		std::optional<Fingerprint> Find(const std::string &name, bool decoded) const;
+
+		/**
+		 * Best effort; concurrent stores of the same entry are safe.
+		 */
+		void Store(const std::string &name, Fingerprint fingerprint) const;
+
+	private:
+		std::string m_Directory;
+
+		std::string GetPath(const std::string &name, bool decoded) const;
+	};
+}
@@ -0,0 +1,97 @@
+#include "pdf_hash.h"
+#include <cstring>
+
+using namespace PDF;
+
+namespace
+{
+	const uint64_t prime1 = 11400714785074694791ULL;
+	const uint64_t prime2 = 14029467366897019727ULL;
+	const uint64_t prime3 = 1609587929392839161ULL;
+	const uint64_t prime4 = 9650029242287828579ULL;
+	const uint64_t prime5 = 2870177450012600261ULL;
+
+	inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+	inline uint64_t read64(const unsigned char *p)
+	{
+		auto v = uint64_t(0);
+		std::memcpy(&v, p, sizeof(v));
+		return v;
+	}
+
+	inline uint32_t read32(const unsigned char *p)
+	{
+		auto v = uint32_t(0);
+		std::memcpy(&v, p, sizeof(v));
+		return v;
+	}
+
+	inline uint64_t lane(uint64_t acc, uint64_t input)
+	{
+		acc += input * prime2;
+		acc = rotl(acc, 31);
+		return acc * prime1;
+	}
+
+	inline uint64_t merge_round(uint64_t acc, uint64_t value)
+	{
+		acc ^= lane(0, value);
+		return acc * prime1 + prime4;
+	}
+}
+
+hash_t PDF::Hash(const void *data, size_t size, hash_t seed) noexcept
+{
+	auto p = static_cast<const unsigned char *>(data);
+	auto end = p + size;
+	auto h = uint64_t(0);
+
+	if (size >= 32)
+	{
+		auto v1 = seed + prime1 + prime2;
+		auto v2 = seed + prime2;
+		auto v3 = seed;
+		auto v4 = seed - prime1;
+		for (; end - p >= 32; p += 32)
+		{
+			v1 = lane(v1, read64(p));
+			v2 = lane(v2, read64(p + 8));
+			v3 = lane(v3, read64(p + 16));
+			v4 = lane(v4, read64(p + 24));
+		}
+		h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+		h = merge_round(h, v1);
+		h = merge_round(h, v2);
+		h = merge_round(h, v3);
+		h = merge_round(h, v4);
+	}
+	else
+		h = seed + prime5;
+
+	h += uint64_t(size);
+
+	for (; end - p >= 8; p += 8)
+	{
+		h ^= lane(0, read64(p));
+		h = rotl(h, 27) * prime1 + prime4;
+	}
+	if (end - p >= 4)
+	{
+		h ^= uint64_t(read32(p)) * prime1;
+		h = rotl(h, 23) * prime2 + prime3;
+		p += 4;
+	}
+	for (; p < end; ++p)
+	{
+		h ^= *p * prime5;
+		h = rotl(h, 11) * prime1;
+	}
+
+	h ^= h >> 33;
+	h *= prime2;
+	h ^= h >> 29;
+	h *= prime3;
+	h ^= h >> 32;
+	return h;
+}
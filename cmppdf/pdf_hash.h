@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace PDF
+{
+	using hash_t = uint64_t;
+
+	/**
+	 * XXH64 of a byte range. Hashes only depend on content, so they are stable
+	 * across runs and processes.
+	 */
+	hash_t Hash(const void *data, size_t size, hash_t seed = 0) noexcept;
+
+	/**
+	 * Fold one more value into a running hash (MurmurHash3 finalizer over both).
+	 */
+	inline hash_t HashCombine(hash_t seed, hash_t value) noexcept
+	{
+		auto h = seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdULL;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ULL;
+		h ^= h >> 33;
+		return h;
+	}
+
+	/**
+	 * Lazily computed structural hash of an immutable value. Zero means "not yet
+	 * computed"; threads racing to fill it store the same value.
+	 */
+	class HashCache
+	{
+	public:
+		HashCache() = default;
+		HashCache(const HashCache &r) noexcept : m_Value(r.m_Value.load(std::memory_order_relaxed)) {}
+
+		HashCache &operator=(const HashCache &r) noexcept
+		{
+			m_Value.store(r.m_Value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			return *this;
+		}
+
+		template <typename Function>
+		hash_t Get(Function compute) const
+		{
+			auto value = m_Value.load(std::memory_order_relaxed);
+			if (!value)
+			{
+				value = compute();
+				if (!value)
+					value = 1;
+				m_Value.store(value, std::memory_order_relaxed);
+			}
+			return value;
+		}
+
+		// The cached value, or zero if it was not computed yet.
+		hash_t Peek() const noexcept { return m_Value.load(std::memory_order_relaxed); }
+
+		void Reset() noexcept { m_Value.store(0, std::memory_order_relaxed); }
+
+	private:
+		mutable std::atomic<hash_t> m_Value{0};
+	};
+}
@@ -0,0 +1,153 @@
+#include "pdf_name.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace PDF;
+
+namespace
+{
+	const size_t chunk_bits = 12;
+	const size_t chunk_size = size_t(1) << chunk_bits;
+	// 4M distinct names. Real files share most of theirs (fonts, resources),
+	// so only a runaway input gets there.
+	const size_t max_chunks = size_t(1) << 10;
+	const size_t text_block = 64 * 1024;
+
+	struct Entry
+	{
+		std::string_view text;
+		hash_t hash;
+	};
+
+	/**
+	 * The text of every name ever seen. Text is packed into blocks that are
+	 * never moved, so views stay valid, and id lookups go through fixed chunks
+	 * published atomically, so View() never takes a lock.
+	 */
+	class Table
+	{
+	public:
+		Table()
+		{
+			Insert("");
+#define PDF_KNOWN_NAME(name) Insert(#name);
+			PDF_KNOWN_NAMES(PDF_KNOWN_NAME)
+#undef PDF_KNOWN_NAME
+		}
+
+		bool Find(std::string_view name, uint32_t &id) const
+		{
+			auto lock = std::shared_lock<std::shared_mutex>(m_Lock);
+			auto it = m_Index.find(name);
+			if (it == m_Index.end())
+				return false;
+			id = it->second;
+			return true;
+		}
+
+		uint32_t Intern(std::string_view name)
+		{
+			auto id = uint32_t(0);
+			if (Find(name, id))
+				return id;
+			auto lock = std::unique_lock<std::shared_mutex>(m_Lock);
+			auto it = m_Index.find(name);
+			if (it != m_Index.end())
+				return it->second;
+			return Insert(name);
+		}
+
+		const Entry &Get(uint32_t id) const noexcept
+		{
+			auto chunk = m_Chunks[id >> chunk_bits].load(std::memory_order_acquire);
+			return chunk[id & (chunk_size - 1)];
+		}
+
+		size_t GetCount() const
+		{
+			auto lock = std::shared_lock<std::shared_mutex>(m_Lock);
+			return m_Count;
+		}
+
+	private:
+		// Caller holds the exclusive lock (or is the constructor).
+		uint32_t Insert(std::string_view name)
+		{
+			auto id = m_Count;
+			if (id >= chunk_size * max_chunks)
+				throw std::length_error("Too many distinct names (" + std::to_string(chunk_size * max_chunks) + ").");
+			auto text = Store(name);
+
+			auto &slot = m_Chunks[id >> chunk_bits];
+			auto chunk = slot.load(std::memory_order_relaxed);
+			if (!chunk)
+			{
+				m_Storage.push_back(std::make_unique<Entry[]>(chunk_size));
+				chunk = m_Storage.back().get();
+			}
+			chunk[id & (chunk_size - 1)] = Entry{text, PDF::Hash(text.data(), text.size())};
+			slot.store(chunk, std::memory_order_release);
+
+			m_Index.emplace(text, uint32_t(id));
+			++m_Count;
+			return uint32_t(id);
+		}
+
+		// Caller holds the exclusive lock. A name longer than a block gets a
+		// block of its own.
+		std::string_view Store(std::string_view name)
+		{
+			if (m_Blocks.empty() || m_Used + name.size() > m_BlockSize)
+			{
+				m_BlockSize = std::max(text_block, name.size());
+				m_Blocks.push_back(std::make_unique<char[]>(m_BlockSize));
+				m_Used = 0;
+			}
+			auto text = m_Blocks.back().get() + m_Used;
+			std::copy(name.begin(), name.end(), text);
+			m_Used += name.size();
+			return std::string_view(text, name.size());
+		}
+
+		mutable std::shared_mutex m_Lock;
+		size_t m_Count = 0;
+		std::vector<std::unique_ptr<char[]>> m_Blocks;
+		size_t m_BlockSize = 0;
+		size_t m_Used = 0;
+		std::unordered_map<std::string_view, uint32_t> m_Index;
+		std::vector<std::unique_ptr<Entry[]>> m_Storage;
+		std::atomic<Entry *> m_Chunks[max_chunks] = {};
+	};
+
+	Table &table()
+	{
+		static auto instance = Table();
+		return instance;
+	}
+}
+
+Name::Name(std::string_view name) : m_Id(table().Intern(name)) {}
+
+bool Name::Find(std::string_view name, Name &found)
+{
+	auto id = uint32_t(0);
+	if (!table().Find(name, id))
+		return false;
+	found.m_Id = id;
+	return true;
+}
+
+size_t Name::GetCount() { return table().GetCount(); }
+size_t Name::GetLimit() noexcept { return chunk_size * max_chunks; }
+
+std::string_view Name::View() const noexcept { return table().Get(m_Id).text; }
+hash_t Name::Hash() const noexcept { return table().Get(m_Id).hash; }
+
+std::ostream &operator<<(std::ostream &out, PDF::Name name) { return out << name.View(); }
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "pdf_hash.h"
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+namespace PDF
+{
+	// Names with a fixed id, registered before any other.
+#define PDF_KNOWN_NAMES(X) \
+	X(Type)                \
+	X(Subtype)             \
+	X(Length)              \
+	X(Filter)              \
+	X(DecodeParms)         \
+	X(Root)                \
+	X(Info)                \
+	X(Size)                \
+	X(Prev)                \
+	X(XRefStm)             \
+	X(ID)                  \
+	X(Encrypt)             \
+	X(W)                   \
+	X(Index)               \
+	X(N)                   \
+	X(First)               \
+	X(XRef)                \
+	X(ObjStm)              \
+	X(Catalog)             \
+	X(Outlines)            \
+	X(Metadata)            \
+	X(Pages)               \
+	X(Page)                \
+	X(Kids)                \
+	X(Count)               \
+	X(Parent)              \
+	X(Resources)           \
+	X(MediaBox)            \
+	X(CropBox)             \
+	X(Rotate)              \
+	X(Contents)            \
+	X(Font)                \
+	X(XObject)             \
+	X(ProcSet)             \
+	X(ExtGState)           \
+	X(ColorSpace)          \
+	X(Pattern)             \
+	X(Shading)             \
+	X(Properties)          \
+	X(BaseFont)            \
+	X(Encoding)            \
+	X(Width)               \
+	X(Height)              \
+	X(Predictor)           \
+	X(Colors)              \
+	X(BitsPerComponent)    \
+	X(Columns)             \
+	X(FlateDecode)         \
+	X(Fl)                  \
+	X(ASCIIHexDecode)      \
+	X(AHx)                 \
+	X(ASCII85Decode)       \
+	X(A85)                 \
+	X(RunLengthDecode)     \
+	X(RL)                  \
+	X(DL)                  \
+	X(CreationDate)        \
+	X(ModDate)             \
+	X(Producer)            \
+	X(Linearized)          \
+	X(L)                   \
+	X(H)                   \
+	X(O)                   \
+	X(E)                   \
+	X(T)
+
+	/**
+	 * Interned PDF name.
+	 *
+	 * Every distinct name is stored once in a process-wide, thread-safe table and
+	 * represented by its id, so equality and ordering are integer comparisons.
+	 * Ids depend on the order names are first seen; anything printed must be
+	 * ordered by View() instead.
+	 *
+	 * The table is append-only, so a Name stays valid for the whole process.
+	 * It is bounded instead: the text is packed into shared blocks, and past
+	 * GetLimit() distinct names interning throws std::length_error.
+	 */
+	class Name
+	{
+	public:
+		enum Known : uint32_t
+		{
+			Empty,
+#define PDF_KNOWN_NAME(name) name,
+			PDF_KNOWN_NAMES(PDF_KNOWN_NAME)
+#undef PDF_KNOWN_NAME
+		};
+
+	public:
+		constexpr Name() noexcept : m_Id(Empty) {}
+		constexpr Name(Known id) noexcept : m_Id(id) {}
+		Name(std::string_view name);
+		Name(const char *name) : Name(std::string_view(name)) {}
+
+		/**
+		 * Look a name up without interning it; false if it was never seen.
+		 */
+		static bool Find(std::string_view name, Name &found);
+
+		/**
+		 * Number of names in the table, the known ones included, and the most
+		 * it will hold.
+		 */
+		static size_t GetCount();
+		static size_t GetLimit() noexcept;
+
+		uint32_t GetId() const noexcept { return m_Id; }
+		std::string_view View() const noexcept;
+
+		// Hash of the text, computed once when the name is interned.
+		hash_t Hash() const noexcept;
+
+		bool operator==(Name r) const noexcept { return m_Id == r.m_Id; }
+		bool operator!=(Name r) const noexcept { return m_Id != r.m_Id; }
+		bool operator<(Name r) const noexcept { return m_Id < r.m_Id; }
+
+	private:
+		uint32_t m_Id;
+	};
+}
+
+std::ostream &operator<<(std::ostream &out, PDF::Name name);
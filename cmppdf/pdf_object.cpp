@@ -1,231 +1,195 @@
 #include "pdf_object.h"
 #include "pdf_except.h"
+#include "pdf_printer.h"
+#include "pdf_report.h"
+#include <climits>
+#include <cstring>
 #include <sstream>
+#include <stdexcept>
+#include <type_traits>
 
 using namespace PDF;
 
-Object::Object(Object::Type type) : m_Type(type) {}
-Object::Object(bool state) : m_Type(Type::BOOLEAN), m_State(state) {}
-Object::Object(double numeric) : m_Type(Type::NUMERIC), m_Numeric(numeric) {}
-Object::Object(string_t string) : m_Type(Type::STRING), m_String(string) {}
-Object::Object(name_t name) : m_Type(Type::NAME), m_Name(name) {}
-Object::Object(array_t array) : m_Type(Type::ARRAY), m_Array(array) {}
-Object::Object(dictionary_t dictionary) : m_Type(Type::DICTIONARY), m_Dictionary(dictionary) {}
-Object::Object(stream_t stream) : m_Type(Type::STREAM), m_Stream(stream) {}
-Object::Object(indirect_t ref) : m_Type(Type::INDIRECT), m_Ref(ref) {}
+static_assert(sizeof(Object) == 16, "Object must stay a compact handle.");
+static_assert(std::is_trivially_copyable_v<Object>, "Object must stay a compact handle.");
 
-Object::Object(const Object &r) { *this = r; }
-Object::Object(Object &&r) { *this = std::move(r); }
-
-Object::~Object() { Clear(); }
+/**
+ * Move a container into the arena of the current thread.
+ */
+template <typename T>
+static const T *box(T &&value)
+{
+	auto p = Arena::Current()->allocate(sizeof(T), alignof(T));
+	return new (p) T(std::move(value));
+}
 
-Object &Object::operator=(const Object &r)
+Object::Object(Object::Type type) : m_Type(type), m_Length(0), m_Numeric(0) {}
+Object::Object(bool state) : m_Type(Type::BOOLEAN), m_Length(0), m_State(state) {}
+Object::Object(double numeric) : m_Type(Type::NUMERIC), m_Length(0), m_Numeric(numeric) {}
+Object::Object(string_t string) : m_Type(Type::STRING), m_Length(uint32_t(string.size())), m_String(string.data())
 {
-#define assign(var) new (&var) decltype(var)(r.var);
-	Clear();
-	m_Type = r.m_Type;
-	switch (m_Type)
-	{
-	case Type::BOOLEAN:
-		m_State = r.m_State;
-		break;
-	case Type::NUMERIC:
-		m_Numeric = r.m_Numeric;
-		break;
-	case Type::STRING:
-		assign(m_String);
-		break;
-	case Type::NAME:
-		assign(m_Name);
-		break;
-	case Type::ARRAY:
-		assign(m_Array);
-		break;
-	case Type::DICTIONARY:
-		assign(m_Dictionary);
-		break;
-	case Type::STREAM:
-		m_Stream = r.m_Stream;
-		break;
-	case Type::INDIRECT:
-		m_Ref = r.m_Ref;
-		break;
-	}
-#undef assign
-	return *this;
+	if (string.size() > UINT32_MAX)
+		throw std::length_error("String too long.");
 }
+Object::Object(name_t name) : m_Type(Type::NAME), m_Length(0), m_Name(name) {}
+Object::Object(array_t array) : m_Type(Type::ARRAY), m_Length(0), m_Array(box(std::move(array))) {}
+Object::Object(dictionary_t dictionary) : m_Type(Type::DICTIONARY), m_Length(0), m_Dictionary(box(std::move(dictionary))) {}
+Object::Object(stream_t stream) : m_Type(Type::STREAM), m_Length(0), m_Stream(box(std::move(stream))) {}
+Object::Object(indirect_t ref, uint16_t generation) : m_Type(Type::INDIRECT), m_Length(generation), m_Ref(ref) {}
 
-Object &Object::operator=(Object &&r)
+bool Object::operator==(const Object &r) const noexcept
 {
-#define assign(var)                 \
-	{                               \
-		new (&var) decltype(var)(); \
-		var.swap(r.var);            \
-	}
-	m_Type = r.m_Type;
+	if (m_Type != r.m_Type)
+		return false;
 	switch (m_Type)
 	{
+	case Type::NIL:
+		return true;
 	case Type::BOOLEAN:
-		m_State = r.m_State;
-		break;
+		return m_State == r.m_State;
 	case Type::NUMERIC:
-		m_Numeric = r.m_Numeric;
-		break;
+		return m_Numeric == r.m_Numeric;
 	case Type::STRING:
-		assign(m_String);
-		break;
+		return GetString() == r.GetString();
 	case Type::NAME:
-		assign(m_Name);
-		break;
+		return m_Name == r.m_Name;
 	case Type::ARRAY:
-		assign(m_Array);
-		break;
+		return m_Array == r.m_Array || *m_Array == *r.m_Array;
 	case Type::DICTIONARY:
-		assign(m_Dictionary);
-		break;
+		return m_Dictionary == r.m_Dictionary || *m_Dictionary == *r.m_Dictionary;
 	case Type::STREAM:
-		m_Stream = r.m_Stream;
-		break;
+		return m_Stream == r.m_Stream || *m_Stream == *r.m_Stream;
 	case Type::INDIRECT:
-		m_Ref = r.m_Ref;
-		break;
+		return m_Ref == r.m_Ref && m_Length == r.m_Length;
+	default:
+		return false;
 	}
-	r.Clear();
-#undef assign
-	return *this;
 }
 
-bool Object::operator==(const Object &r) const noexcept
+hash_t Object::Hash() const
 {
-	if (m_Type != r.m_Type)
-		return false;
+	auto seed = hash_t(m_Type);
 	switch (m_Type)
 	{
-	case Type::NIL:
-		return true;
 	case Type::BOOLEAN:
-		return m_State == r.m_State;
+		return HashCombine(seed, m_State);
 	case Type::NUMERIC:
-		return m_Numeric == r.m_Numeric;
+	{
+		// -0 == 0, so both must hash alike.
+		auto numeric = m_Numeric == 0 ? 0.0 : m_Numeric;
+		auto bits = uint64_t(0);
+		std::memcpy(&bits, &numeric, sizeof(bits));
+		return HashCombine(seed, bits);
+	}
 	case Type::STRING:
-		return m_String == r.m_String;
+		return PDF::Hash(m_String, m_Length, seed);
 	case Type::NAME:
-		return m_Name == r.m_Name;
+		// By text, not id: ids depend on the order names were interned.
+		return HashCombine(seed, m_Name.Hash());
 	case Type::ARRAY:
-		return m_Array == r.m_Array;
+		return HashCombine(seed, m_Array->Hash());
 	case Type::DICTIONARY:
-		return m_Dictionary == r.m_Dictionary;
+		return HashCombine(seed, m_Dictionary->Hash());
 	case Type::STREAM:
-		return m_Stream == r.m_Stream;
+		return HashCombine(seed, m_Stream->Hash());
 	case Type::INDIRECT:
-		return m_Ref == r.m_Ref;
+		// Generation 0 keeps the hashes of files without reused object numbers.
+		return m_Length ? HashCombine(HashCombine(seed, m_Ref), m_Length) : HashCombine(seed, m_Ref);
 	default:
-		return false;
+		return HashCombine(seed, 0);
 	}
 }
 
-void Object::diff(std::ostream &out, const Object &r, size_t depth) const
+void Object::diff(DiffReport &report, const Object &r, size_t depth) const
 {
-#define check(item, name)                                                                           \
-	if (name != r.name)                                                                             \
-	{                                                                                               \
-		out << std::setw(depth * 4) << ' ' << item << ": " << name << " / " << r.name << std::endl; \
+	// Values as operator<< prints them.
+	auto text = [](const auto &value) {
+		auto out = std::ostringstream();
+		out << value;
+		return out.str();
+	};
+
+#define check(item, name)                                                             \
+	if (name != r.name)                                                               \
+	{                                                                                 \
+		report.Add(DiffRecord::Kind::Changed, depth, item, text(name), text(r.name)); \
 	}
 
 	check("Type", m_Type) else switch (m_Type)
 	{
+	case Type::NIL:
+		// Nothing beyond the type.
+		break;
 	case Type::BOOLEAN:
 		check("Boolean", m_State) break;
 	case Type::NUMERIC:
 		check("Numeric", m_Numeric) break;
 	case Type::STRING:
-		check("String", m_String) break;
+		check("String", GetString()) break;
 	case Type::NAME:
 		check("Name", m_Name) break;
 	case Type::ARRAY:
-		m_Array.diff(out, r.m_Array, depth);
+		m_Array->diff(report, *r.m_Array, depth);
 		break;
 	case Type::DICTIONARY:
-		m_Dictionary.diff(out, r.m_Dictionary, depth);
+		m_Dictionary->diff(report, *r.m_Dictionary, depth);
 		break;
 	case Type::STREAM:
-		m_Stream.diff(out, r.m_Stream, depth);
+		m_Stream->diff(report, *r.m_Stream, depth);
 		break;
 	case Type::INDIRECT:
-		check("Indirect", m_Ref) break;
+		check("Indirect", m_Ref) else check("Generation", m_Length) break;
 	}
 #undef check
 }
 
-bool Object::HasKey(const char *key) const
+bool Object::operator==(const char *name) const noexcept
+{
+	// A name that was never interned cannot match, so don't intern it now.
+	auto found = name_t();
+	return m_Type == Type::NAME && name_t::Find(name, found) && m_Name == found;
+}
+
+bool Object::HasKey(name_t key) const
 {
 	if (m_Type != Type::DICTIONARY)
 		throw type_error(__FILE__);
-	return m_Dictionary.HasKey(key);
+	return m_Dictionary->HasKey(key);
 }
 
-const Object &Object::operator[](const char *key) const
+const Object &Object::operator[](name_t key) const
 {
 	if (m_Type != Type::DICTIONARY)
 		throw type_error(__FILE__);
-	return m_Dictionary[key];
+	return (*m_Dictionary)[key];
 }
 
-std::string Object::Display() const noexcept
+const array_t &Object::GetArray() const
 {
-	auto s = std::stringstream();
-	switch (GetType())
-	{
-	case PDF::Object::Type::NIL:
-		s << "null";
-		break;
-	case PDF::Object::Type::BOOLEAN:
-		s << GetBoolean();
-		break;
-	case PDF::Object::Type::NUMERIC:
-		s << GetNumeric();
-		break;
-	case PDF::Object::Type::STRING:
-		s << std::string(GetString());
-		break;
-	case PDF::Object::Type::NAME:
-		s << '/' << GetName();
-		break;
-	case PDF::Object::Type::ARRAY:
-		s << GetArray().Display();
-		break;
-	case PDF::Object::Type::DICTIONARY:
-		s << GetDictionary().Display();
-		break;
-	case PDF::Object::Type::STREAM:
-		s << GetStream().Display();
-		break;
-	case PDF::Object::Type::INDIRECT:
-		s << GetIndirect() << " 0 R";
-		break;
-	}
+	if (m_Type != Type::ARRAY)
+		throw type_error(__FILE__);
+	return *m_Array;
+}
 
-	return s.str();
+const dictionary_t &Object::GetDictionary() const
+{
+	if (m_Type != Type::DICTIONARY)
+		throw type_error(__FILE__);
+	return *m_Dictionary;
 }
 
-void Object::Clear()
+const stream_t &Object::GetStream() const
 {
-	switch (m_Type)
-	{
-	case Type::STRING:
-		m_String.~string_t();
-		break;
-	case Type::NAME:
-		m_Name.~name_t();
-		break;
-	case Type::ARRAY:
-		m_Array.~array_t();
-		break;
-	case Type::DICTIONARY:
-		m_Dictionary.~dictionary_t();
-		break;
-	}
-	m_Type = Type::NIL;
+	if (m_Type != Type::STREAM)
+		throw type_error(__FILE__);
+	return *m_Stream;
+}
+
+std::string Object::Display() const noexcept
+{
+	auto s = std::string();
+	Printer(s).Print(*this);
+	return s;
 }
 
 /******************************************************************************
@@ -234,37 +198,9 @@ void Object::Clear()
 
 std::ostream &operator<<(std::ostream &out, const PDF::Object &obj)
 {
-	switch (obj.GetType())
-	{
-	case PDF::Object::Type::NIL:
-		out << "null";
-		break;
-	case PDF::Object::Type::BOOLEAN:
-		out << obj.GetBoolean();
-		break;
-	case PDF::Object::Type::NUMERIC:
-		out << obj.GetNumeric();
-		break;
-	case PDF::Object::Type::STRING:
-		out << std::string(obj.GetString());
-		break;
-	case PDF::Object::Type::NAME:
-		out << obj.GetName();
-		break;
-	case PDF::Object::Type::ARRAY:
-		out << obj.GetArray();
-		break;
-	case PDF::Object::Type::DICTIONARY:
-		out << obj.GetDictionary();
-		break;
-	case PDF::Object::Type::STREAM:
-		out << obj.GetStream();
-		break;
-	case PDF::Object::Type::INDIRECT:
-		out << obj.GetIndirect();
-		break;
-	}
-	return out;
+	auto s = std::string();
+	Printer(s).Summary(obj);
+	return out << s;
 }
 
 std::ostream &operator<<(std::ostream &out, const PDF::Object::Type &type)
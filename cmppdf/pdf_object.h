@@ -2,6 +2,7 @@
 
 #include "pdf_array.h"
 #include "pdf_dictionary.h"
+#include "pdf_name.h"
 #include "pdf_stream.h"
 #include <iomanip>
 #include <vector>
@@ -13,16 +14,24 @@ namespace PDF
 	class Object;
 
 	using string_t = std::string_view;
-	using name_t = std::string;
+	using name_t = Name;
 	using array_t = Array;
 	using dictionary_t = Dictionary;
 	using stream_t = Stream;
 	using indirect_t = uint32_t;
 
+	/**
+	 * A 16 byte handle: type tag, length of a string, and an 8 byte payload.
+	 *
+	 * Scalars are stored inline. Strings point into the file image, and arrays,
+	 * dictionaries and streams are boxed in the arena of the current thread, so
+	 * copying an Object never copies its contents. Boxed containers are never
+	 * modified once wrapped and live as long as their arena.
+	 */
 	class Object
 	{
 	public:
-		enum class Type
+		enum class Type : uint8_t
 		{
 			NIL,
 			BOOLEAN,
@@ -44,57 +53,61 @@ namespace PDF
 		Object(array_t array);
 		Object(dictionary_t dictionary);
 		Object(stream_t stream);
-		Object(indirect_t indirect);
-		Object(const Object &r);
-		Object(Object &&r);
-		virtual ~Object();
-
-		Object &operator=(const Object &r);
-		Object &operator=(Object &&r);
+		Object(indirect_t indirect, uint16_t generation = 0);
 
 		operator bool() const noexcept { return m_Type == Type::NIL; }
 
 		bool operator==(const Object &r) const noexcept;
 		bool operator!=(const Object &r) const noexcept { return !(*this == r); }
-		void diff(std::ostream &out, const Object &r, size_t depth = 0) const;
+		void diff(DiffReport &report, const Object &r, size_t depth = 0) const;
+
+		/**
+		 * Structural hash: scalars are hashed on the fly, containers and
+		 * streams return their cached hash.
+		 */
+		hash_t Hash() const;
 
 		bool operator==(Type type) const noexcept { return m_Type == type; }
 		bool operator!=(Type type) const noexcept { return m_Type != type; }
-		bool operator==(const char *name) const noexcept { return m_Type == Type::NAME && m_Name == name; }
-		bool operator!=(const char *name) const noexcept { return m_Type != Type::NAME || m_Name != name; }
+		bool operator==(name_t name) const noexcept { return m_Type == Type::NAME && m_Name == name; }
+		bool operator!=(name_t name) const noexcept { return m_Type != Type::NAME || m_Name != name; }
+		bool operator==(Name::Known name) const noexcept { return *this == name_t(name); }
+		bool operator!=(Name::Known name) const noexcept { return *this != name_t(name); }
+		bool operator==(const char *name) const noexcept;
+		bool operator!=(const char *name) const noexcept { return !(*this == name); }
 
-		bool HasKey(const char *key) const;
-		const Object &operator[](const char *key) const;
+		bool HasKey(name_t key) const;
+		const Object &operator[](name_t key) const;
 
 		Type GetType() const noexcept { return m_Type; }
 
 		bool GetBoolean() const noexcept { return m_State; }
 		double GetNumeric() const noexcept { return m_Numeric; }
-		string_t GetString() const noexcept { return m_String; }
+		string_t GetString() const noexcept { return string_t(m_String, m_Length); }
 		name_t GetName() const noexcept { return m_Name; }
-		array_t GetArray() const noexcept { return m_Array; }
-		dictionary_t GetDictionary() const noexcept { return m_Dictionary; }
-		stream_t GetStream() const noexcept { return m_Stream; }
+		const array_t &GetArray() const;
+		const dictionary_t &GetDictionary() const;
+		const stream_t &GetStream() const;
 		indirect_t GetIndirect() const noexcept { return m_Ref; }
+		uint16_t GetGeneration() const noexcept { return uint16_t(m_Length); } // of an indirect reference
 
 		std::string Display() const noexcept;
 
 	private:
 		Type m_Type;
+		uint32_t m_Length; // of a string; the generation of an indirect reference
 
 		union
 		{
 			bool m_State;
 			double m_Numeric;
-			string_t m_String;
+			const char *m_String;
 			name_t m_Name;
-			array_t m_Array;
-			dictionary_t m_Dictionary;
-			stream_t m_Stream;
+			const array_t *m_Array;
+			const dictionary_t *m_Dictionary;
+			const stream_t *m_Stream;
 			indirect_t m_Ref;
 		};
-
-		void Clear();
 	};
 }
 
@@ -0,0 +1,268 @@
+#include "pdf_printer.h"
+#include <algorithm>
+#include <charconv>
+
+using namespace PDF;
+
+static bool by_text(const Dictionary::value_type *l, const Dictionary::value_type *r) { return l->first != r->first && l->first.View() < r->first.View(); }
+
+/**
+ * Everything written for one object is bounded by PrintLimits::bytes: the
+ * containers stop as soon as the bound is reached, and the excess is cut.
+ */
+template <typename T>
+void Printer::Bounded(const T &value)
+{
+	auto begin = m_Buffer.size();
+	m_End = begin + m_Limits.bytes;
+	m_Depth = 0;
+	Value(value);
+	if (m_Buffer.size() > m_End)
+	{
+		m_Buffer.resize(m_End);
+		m_Buffer += "...";
+	}
+}
+
+void Printer::Print(const Object &obj) { Bounded(obj); }
+void Printer::Print(const Array &array) { Bounded(array); }
+void Printer::Print(const Dictionary &dic) { Bounded(dic); }
+void Printer::Print(const Stream &stream) { Bounded(stream); }
+
+void Printer::Summary(const Object &obj)
+{
+	switch (obj.GetType())
+	{
+	case Object::Type::NIL:
+		m_Buffer += "null";
+		break;
+	case Object::Type::BOOLEAN:
+		m_Buffer += obj.GetBoolean() ? '1' : '0';
+		break;
+	case Object::Type::NUMERIC:
+		Number(obj.GetNumeric());
+		break;
+	case Object::Type::STRING:
+		m_Buffer += obj.GetString();
+		break;
+	case Object::Type::NAME:
+		m_Buffer += obj.GetName().View();
+		break;
+	case Object::Type::ARRAY:
+		m_Buffer += "Array(";
+		Number(obj.GetArray().size());
+		m_Buffer += ')';
+		break;
+	case Object::Type::DICTIONARY:
+		Summary(obj.GetDictionary());
+		break;
+	case Object::Type::STREAM:
+		Number(obj.GetStream().GetSize());
+		break;
+	case Object::Type::INDIRECT:
+		Number(size_t(obj.GetIndirect()));
+		break;
+	}
+}
+
+void Printer::Summary(const Dictionary &dic)
+{
+	if (dic.HasKey(Name::Type) && dic[Name::Type] == Object::Type::NAME)
+		m_Buffer.append(dic[Name::Type].GetName().View()).append(": ");
+	else if (dic.HasKey(Name::Font))
+		m_Buffer += "Font: ";
+	else if (dic.HasKey(Name::CreationDate) || dic.HasKey(Name::ModDate) || dic.HasKey(Name::Producer))
+		m_Buffer += "Info: ";
+	else if (dic.HasKey(Name::Length))
+		m_Buffer += "Stream?: ";
+	else
+		m_Buffer += "*: ";
+	Print(dic);
+}
+
+void Printer::Print(const Xref &xref)
+{
+	if (xref.container)
+	{
+		auto location = std::to_string(xref.container);
+		location += ':';
+		location += std::to_string(xref.index);
+		Column(location, 10);
+	}
+	else
+		Column(std::to_string(xref.offset), 10);
+	m_Buffer += ' ';
+	Column(std::to_string(xref.revision), 5);
+	m_Buffer += ' ';
+	Column(xref.used ? "use" : "unused", 6);
+	m_Buffer += ' ';
+	Summary(xref.object);
+	if (xref.stream.GetSize() > 0)
+	{
+		m_Buffer += " stream[";
+		Number(xref.stream.GetSize());
+		m_Buffer += ']';
+	}
+}
+
+void Printer::Column(size_t value, size_t width)
+{
+	char text[24];
+	auto end = std::to_chars(text, text + sizeof(text), value).ptr;
+	Column(std::string_view(text, end - text), width);
+}
+
+void Printer::Column(std::string_view text, size_t width)
+{
+	if (text.size() < width)
+		m_Buffer.append(width - text.size(), ' ');
+	m_Buffer += text;
+}
+
+/******************************************************************************
+
+******************************************************************************/
+
+void Printer::Value(const Object &obj)
+{
+	switch (obj.GetType())
+	{
+	case Object::Type::NAME:
+		m_Buffer += '/';
+		m_Buffer += obj.GetName().View();
+		break;
+	case Object::Type::ARRAY:
+		Value(obj.GetArray());
+		break;
+	case Object::Type::DICTIONARY:
+		Value(obj.GetDictionary());
+		break;
+	case Object::Type::STREAM:
+		Value(obj.GetStream());
+		break;
+	case Object::Type::INDIRECT:
+		Number(size_t(obj.GetIndirect()));
+		m_Buffer += ' ';
+		Number(size_t(obj.GetGeneration()));
+		m_Buffer += " R";
+		break;
+	default:
+		Summary(obj);
+		break;
+	}
+}
+
+/**
+ * Entries are followed by a blank each. An array whose entries take more
+ * than PrintLimits::array_bytes is rewritten as its size, so it is only
+ * written up to that point.
+ */
+void Printer::Value(const Array &array)
+{
+	if (m_Depth >= m_Limits.depth)
+	{
+		m_Buffer += "[...]";
+		return;
+	}
+
+	auto begin = m_Buffer.size();
+	auto end = m_End;
+	m_End = std::min(end, begin + 1 + m_Limits.array_bytes + 1);
+
+	++m_Depth;
+	m_Buffer += '[';
+	auto count = size_t(0);
+	for (const auto &obj : array)
+	{
+		if (Full())
+			break;
+		if (count++ == m_Limits.elements)
+		{
+			m_Buffer += "..";
+			Number(array.size() - m_Limits.elements);
+			m_Buffer += " more.. ";
+			break;
+		}
+		Value(obj);
+		m_Buffer += ' ';
+	}
+	--m_Depth;
+
+	m_End = end;
+	if (m_Buffer.size() - begin - 1 > m_Limits.array_bytes)
+	{
+		m_Buffer.resize(begin);
+		m_Buffer += "[..";
+		Number(array.size());
+		m_Buffer += "..";
+	}
+	m_Buffer += ']';
+}
+
+void Printer::Value(const Dictionary &dic)
+{
+	if (m_Depth >= m_Limits.depth)
+	{
+		m_Buffer += "<<...>>";
+		return;
+	}
+
+	if (m_Items.size() <= m_Depth)
+		m_Items.resize(m_Depth + 1);
+	auto &items = m_Items[m_Depth];
+	items.clear();
+	for (const auto &item : dic)
+		items.push_back(&item);
+	std::sort(items.begin(), items.end(), by_text);
+
+	++m_Depth;
+	m_Buffer += "<<";
+	auto count = size_t(0);
+	for (const auto *item : items)
+	{
+		if (Full())
+			break;
+		if (count++ == m_Limits.elements)
+		{
+			m_Buffer += "..";
+			Number(items.size() - m_Limits.elements);
+			m_Buffer += " more.. ";
+			break;
+		}
+		m_Buffer += '/';
+		m_Buffer += item->first.View();
+		m_Buffer += ' ';
+		Value(item->second);
+		m_Buffer += ' ';
+	}
+	--m_Depth;
+	m_Buffer += ">>";
+}
+
+/**
+ * Where the data lies in memory.
+ */
+void Printer::Value(const Stream &stream)
+{
+	char text[40];
+	auto begin = reinterpret_cast<uintptr_t>(stream.GetData());
+	auto end = std::to_chars(text, text + sizeof(text), begin, 16).ptr;
+	*end++ = '-';
+	end = std::to_chars(end, text + sizeof(text), begin + stream.GetSize(), 16).ptr;
+	m_Buffer.append(text, end);
+}
+
+void Printer::Number(double value)
+{
+	// As std::ostream writes it by default.
+	char text[32];
+	auto end = std::to_chars(text, text + sizeof(text), value, std::chars_format::general, 6).ptr;
+	m_Buffer.append(text, end);
+}
+
+void Printer::Number(size_t value)
+{
+	char text[24];
+	auto end = std::to_chars(text, text + sizeof(text), value).ptr;
+	m_Buffer.append(text, end);
+}
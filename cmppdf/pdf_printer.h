@@ -0,0 +1,76 @@
+#pragma once
+
+#include "pdf_xref.h"
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace PDF
+{
+	/**
+	 * Bounds on the text written for one object, so that neither time nor
+	 * memory depends on how large or how deep a container is.
+	 */
+	struct PrintLimits
+	{
+		size_t depth = 16;		  // containers nested deeper print as [...] and <<...>>
+		size_t elements = 256;	  // entries shown per array or dictionary
+		size_t bytes = 16 * 1024; // per object, cut with "..." beyond
+		size_t array_bytes = 32;  // longer arrays print as [..n..], n being their size
+	};
+
+	/**
+	 * Writes objects in a single pass into a buffer owned by the caller,
+	 * which can be reused from one object to the next. Nested containers are
+	 * written in place, never built as strings of their own.
+	 */
+	class Printer
+	{
+	public:
+		explicit Printer(std::string &buffer, const PrintLimits &limits = PrintLimits()) : m_Buffer(buffer), m_Limits(limits) {}
+
+		// PDF syntax, as Display() returns it: <</Type /Page /Parent 2 0 R >>
+		void Print(const Object &obj);
+		void Print(const Array &array);
+		void Print(const Dictionary &dic);
+		void Print(const Stream &stream);
+
+		// The short form of operator<<: the kind of a dictionary and its
+		// entries, only the size of arrays and streams.
+		void Summary(const Object &obj);
+		void Summary(const Dictionary &dic);
+
+		// A row of the object listing without its number: offset (or
+		// container:index), revision, use and the object.
+		void Print(const Xref &xref);
+
+		// `value` right-aligned in `width` columns, as std::setw does.
+		void Column(size_t value, size_t width);
+		void Column(std::string_view text, size_t width);
+
+	private:
+		using items_t = std::vector<const Dictionary::value_type *>;
+
+		std::string &m_Buffer;
+		PrintLimits m_Limits;
+
+		// The buffer is not written past this while an object is printed.
+		size_t m_End = 0;
+		size_t m_Depth = 0;
+
+		// Sorted entries of the dictionary being printed at each depth; a deque,
+		// so that growing it for a nested dictionary keeps the outer ones in place.
+		std::deque<items_t> m_Items;
+
+		template <typename T>
+		void Bounded(const T &value);
+		bool Full() const noexcept { return m_Buffer.size() >= m_End; }
+
+		void Value(const Object &obj);
+		void Value(const Array &array);
+		void Value(const Dictionary &dic);
+		void Value(const Stream &stream);
+		void Number(double value);
+		void Number(size_t value);
+	};
+}
@@ -0,0 +1,234 @@
+#include "pdf_report.h"
+#include <algorithm>
+#include <limits>
+
+using namespace PDF;
+
+namespace
+{
+	const size_t block_size = 64 * 1024;
+
+	const char *const kind_names[] = {"section", "group", "changed", "note", "offset", "range", "removed", "inserted"};
+
+	/**
+	 * The lines cmppdf has always printed: four blanks per depth.
+	 */
+	class TextWriter : public ReportWriter
+	{
+	public:
+		using ReportWriter::ReportWriter;
+		using ReportWriter::Write;
+
+		void Write(const DiffRecord &record) override
+		{
+			m_Buffer.append(record.depth * 4, ' ');
+			switch (record.kind)
+			{
+			case DiffRecord::Kind::Section:
+				m_Buffer += record.label;
+				break;
+			case DiffRecord::Kind::Group:
+				m_Buffer.append(record.label).append(":");
+				break;
+			case DiffRecord::Kind::Changed:
+				m_Buffer.append(record.label).append(": ").append(record.left).append(" / ").append(record.right);
+				break;
+			case DiffRecord::Kind::Note:
+				m_Buffer.append(record.label).append(": ").append(record.left);
+				break;
+			case DiffRecord::Kind::Offset:
+				m_Buffer.append(record.label).append("[").append(record.left).append("]");
+				break;
+			case DiffRecord::Kind::Range:
+				m_Buffer.append(record.label).append("[").append(record.left).append(") / [").append(record.right).append(")");
+				break;
+			case DiffRecord::Kind::Removed:
+				m_Buffer.append("< ").append(record.left);
+				break;
+			case DiffRecord::Kind::Inserted:
+				m_Buffer.append("> ").append(record.right);
+				break;
+			}
+			m_Buffer += '\n';
+		}
+	};
+
+	/**
+	 * One object per line:
+	 *   {"path":["Xref table [5]","Object","Numeric"],"kind":"changed","left":"1","right":"2"}
+	 * The path holds the labels of the enclosing records and of the record
+	 * itself. "left" and "right" are left out when empty; a note has a
+	 * "message" instead. Strings are raw bytes from the documents, so every
+	 * byte outside printable ASCII is escaped as \u00XX.
+	 */
+	class JsonWriter : public ReportWriter
+	{
+	public:
+		using ReportWriter::ReportWriter;
+		using ReportWriter::Write;
+
+		void Write(const DiffRecord &record) override
+		{
+			while (!m_Path.empty() && m_Path.back().first >= record.depth)
+				m_Path.pop_back();
+
+			m_Buffer += "{\"path\":[";
+			for (const auto &item : m_Path)
+			{
+				String(item.second);
+				m_Buffer += ',';
+			}
+			if (!record.label.empty())
+				String(record.label);
+			else if (!m_Path.empty())
+				m_Buffer.pop_back();
+			m_Buffer.append("],\"kind\":\"").append(kind_names[size_t(record.kind)]).append("\"");
+			if (record.kind == DiffRecord::Kind::Note)
+				Field("message", record.left);
+			else
+			{
+				Field("left", record.left);
+				Field("right", record.right);
+			}
+			m_Buffer += "}\n";
+
+			if (!record.label.empty())
+				m_Path.emplace_back(record.depth, std::string(record.label));
+		}
+
+	private:
+		std::vector<std::pair<size_t, std::string>> m_Path;
+
+		void Field(std::string_view name, std::string_view value)
+		{
+			if (value.empty())
+				return;
+			m_Buffer.append(",\"").append(name).append("\":");
+			String(value);
+		}
+
+		void String(std::string_view text)
+		{
+			static const char hex[] = "0123456789abcdef";
+			m_Buffer += '"';
+			for (auto ch : text)
+			{
+				auto byte = uint8_t(ch);
+				if (ch == '"' || ch == '\\')
+					m_Buffer.append(1, '\\').append(1, ch);
+				else if (byte >= 0x20 && byte < 0x7f)
+					m_Buffer += ch;
+				else
+					m_Buffer.append("\\u00").append(1, hex[byte >> 4]).append(1, hex[byte & 15]);
+			}
+			m_Buffer += '"';
+		}
+	};
+
+	/**
+	 * "CMPPDFDR" and a format byte (1), then per record: the kind as one
+	 * byte (DiffRecord::Kind), the depth, and label, left and right each as
+	 * a length and its bytes. Numbers are unsigned LEB128 varints, so the
+	 * format does not depend on the host.
+	 */
+	class BinaryWriter : public ReportWriter
+	{
+	public:
+		using ReportWriter::Write;
+
+		// The header comes first even when no record follows.
+		explicit BinaryWriter(std::ostream &out) : ReportWriter(out) { m_Buffer.append("CMPPDFDR").append(1, char(1)); }
+
+		void Write(const DiffRecord &record) override
+		{
+			m_Buffer += char(record.kind);
+			Number(record.depth);
+			for (auto text : {record.label, record.left, record.right})
+			{
+				Number(text.size());
+				m_Buffer += text;
+			}
+		}
+
+	private:
+		void Number(uint64_t value)
+		{
+			for (; value >= 0x80; value >>= 7)
+				m_Buffer += char((value & 0x7f) | 0x80);
+			m_Buffer += char(value);
+		}
+	};
+}
+
+void DiffReport::Add(DiffRecord::Kind kind, size_t depth, std::string_view label, std::string_view left, std::string_view right)
+{
+	auto entry = Entry();
+	entry.text = m_Text.size();
+	entry.label_size = uint32_t(label.size());
+	entry.left_size = uint32_t(left.size());
+	entry.right_size = uint32_t(right.size());
+	entry.depth = uint16_t(std::min<size_t>(depth, std::numeric_limits<uint16_t>::max()));
+	entry.kind = kind;
+	m_Text.append(label.substr(0, entry.label_size)).append(left.substr(0, entry.left_size)).append(right.substr(0, entry.right_size));
+	m_Entries.push_back(entry);
+}
+
+void DiffReport::Append(const DiffReport &r, size_t depth)
+{
+	for (auto i = size_t(0); i < r.size(); ++i)
+	{
+		auto record = r[i];
+		Add(record.kind, record.depth + depth, record.label, record.left, record.right);
+	}
+}
+
+DiffRecord DiffReport::operator[](size_t index) const
+{
+	const auto &entry = m_Entries.at(index);
+	auto text = std::string_view(m_Text).substr(entry.text);
+	auto record = DiffRecord();
+	record.kind = entry.kind;
+	record.depth = entry.depth;
+	record.label = text.substr(0, entry.label_size);
+	record.left = text.substr(entry.label_size, entry.left_size);
+	record.right = text.substr(entry.label_size + entry.left_size, entry.right_size);
+	return record;
+}
+
+/******************************************************************************
+
+******************************************************************************/
+
+std::unique_ptr<ReportWriter> ReportWriter::Create(std::string_view format, std::ostream &out)
+{
+	if (format == "text")
+		return std::make_unique<TextWriter>(out);
+	if (format == "ndjson")
+		return std::make_unique<JsonWriter>(out);
+	if (format == "binary")
+		return std::make_unique<BinaryWriter>(out);
+	return nullptr;
+}
+
+void ReportWriter::Write(const DiffReport &report)
+{
+	for (auto i = size_t(0); i < report.size(); ++i)
+	{
+		Write(report[i]);
+		if (m_Buffer.size() >= block_size)
+			Drain();
+	}
+	Flush();
+}
+
+void ReportWriter::Flush()
+{
+	Drain();
+	m_Out.flush();
+}
+
+void ReportWriter::Drain()
+{
+	m_Out.write(m_Buffer.data(), std::streamsize(m_Buffer.size()));
+	m_Buffer.clear();
+}
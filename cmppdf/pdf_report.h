@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace PDF
+{
+	/**
+	 * One line of a diff. `depth` nests a record under the last one before it
+	 * with a smaller depth, usually a Section or Group; together their labels
+	 * are the path.
+	 */
+	struct DiffRecord
+	{
+		enum class Kind : uint8_t
+		{
+			Section,  // label, e.g. "Xref table [5]"
+			Group,	  // label:, e.g. a dictionary key whose value differs
+			Changed,  // label: left / right
+			Note,	  // label: left, a message
+			Offset,	  // label[left], first differing byte
+			Range,	  // label[left) / [right), e.g. "Range[4, 8) / [4, 9)"
+			Removed,  // < left
+			Inserted, // > right
+		};
+
+		Kind kind = Kind::Note;
+		size_t depth = 0;
+		std::string_view label;
+		std::string_view left;
+		std::string_view right;
+	};
+
+	/**
+	 * The differences found by the diff functions, in order. Records are
+	 * kept in one buffer of text and a small fixed-size entry each, so a
+	 * report of millions of differences stays compact; it is rendered
+	 * afterwards by a ReportWriter.
+	 */
+	class DiffReport
+	{
+	public:
+		void Add(DiffRecord::Kind kind, size_t depth, std::string_view label, std::string_view left = {}, std::string_view right = {});
+
+		/**
+		 * Numbers and strings, written as std::ostream does.
+		 */
+		template <typename T>
+		void Changed(size_t depth, std::string_view label, const T &left, const T &right)
+		{
+			Add(DiffRecord::Kind::Changed, depth, label, Text(left), Text(right));
+		}
+
+		// Records of `r` follow, `depth` deeper.
+		void Append(const DiffReport &r, size_t depth = 0);
+
+		bool empty() const noexcept { return m_Entries.empty(); }
+		size_t size() const noexcept { return m_Entries.size(); }
+
+		// The views are valid until the next Add or Append.
+		DiffRecord operator[](size_t index) const;
+
+	private:
+		// The label, left and right text of an entry lie back to back at `text`.
+		struct Entry
+		{
+			uint64_t text;
+			uint32_t label_size;
+			uint32_t left_size;
+			uint32_t right_size;
+			uint16_t depth;
+			DiffRecord::Kind kind;
+		};
+
+		std::string m_Text;
+		std::vector<Entry> m_Entries;
+
+		template <typename T>
+		static std::string Text(const T &value)
+		{
+			auto out = std::ostringstream();
+			out << value;
+			return out.str();
+		}
+	};
+
+	/**
+	 * Renders reports into a stream through its own buffer, so that output
+	 * is written in large blocks instead of a flush per line.
+	 */
+	class ReportWriter
+	{
+	public:
+		explicit ReportWriter(std::ostream &out) : m_Out(out) {}
+		virtual ~ReportWriter() = default;
+
+		/**
+		 * "text" (indented lines), "ndjson" (one JSON object per record with
+		 * its full path) or "binary" (see pdf_report.cpp); null for anything
+		 * else.
+		 */
+		static std::unique_ptr<ReportWriter> Create(std::string_view format, std::ostream &out);
+
+		void Write(const DiffReport &report);
+		virtual void Write(const DiffRecord &record) = 0;
+
+		// Writes out the buffer and flushes the stream; called at the end of
+		// every Write(report).
+		void Flush();
+
+	protected:
+		// Written out whenever it passes a block.
+		std::string m_Buffer;
+
+	private:
+		std::ostream &m_Out;
+
+		// Writes out the buffer without flushing the stream.
+		void Drain();
+	};
+}
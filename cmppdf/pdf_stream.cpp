@@ -1,14 +1,17 @@
-#pragma once
-
 #include "pdf_stream.h"
-#include <sstream>
+#include "pdf_compare.h"
+#include "pdf_printer.h"
+#include "pdf_report.h"
 
 using namespace PDF;
 
+size_t Stream::s_Granularity = Stream::first_only;
+
 Stream &Stream::operator=(const Stream &r)
 {
 	m_Begin = r.m_Begin;
 	m_Size = r.m_Size;
+	m_Hash = r.m_Hash;
 	return *this;
 }
 
@@ -16,6 +19,7 @@ Stream &Stream::operator=(Stream &&r)
 {
 	m_Begin = r.m_Begin;
 	m_Size = r.m_Size;
+	m_Hash = r.m_Hash;
 	return *this;
 }
 
@@ -23,33 +27,56 @@ bool Stream::operator==(const Stream &r) const noexcept
 {
 	if (m_Size != r.m_Size)
 		return false;
-	const auto s = reinterpret_cast<uint8_t *>(m_Begin);
-	const auto d = reinterpret_cast<uint8_t *>(r.m_Begin);
-	return !std::memcmp(s, d, m_Size);
+	if (!m_Size)
+		return true;
+
+	// Only use hashes that are already known: for a one-off comparison a
+	// byte compare is cheaper than hashing both sides and stops at the first
+	// difference. Different hashes reject; equal ones can still collide.
+	auto lh = m_Hash.Peek();
+	auto rh = r.m_Hash.Peek();
+	if (lh && rh && lh != rh)
+		return false;
+	return CompareBytes(GetData(), r.GetData(), m_Size).Equal();
 }
 
-void Stream::diff(std::ostream &out, const Stream &r, size_t depth) const noexcept
+void Stream::diff(DiffReport &report, const Stream &r, size_t depth) const noexcept
 {
-	if (m_Size != r.m_Size)
-		out << std::setw(depth * 4) << ' ' << "Size: " << m_Size << " / " << r.m_Size << std::endl;
+	DiffBytes(report, GetData(), m_Size, r.GetData(), r.m_Size, depth);
+}
+
+void Stream::DiffBytes(DiffReport &report, const char *l, size_t lsize, const char *r, size_t rsize, size_t depth) noexcept
+{
+	if (s_Granularity != first_only)
+	{
+		if (lsize != rsize)
+			report.Changed(depth, "Size", lsize, rsize);
+		DiffRanges(l, lsize, r, rsize, s_Granularity, [&](const ByteRange &range) {
+			report.Add(DiffRecord::Kind::Range, depth, "Range",
+					   std::to_string(range.left) + ", " + std::to_string(range.left + range.left_size),
+					   std::to_string(range.right) + ", " + std::to_string(range.right + range.right_size));
+		});
+	}
+	else if (lsize != rsize)
+		report.Changed(depth, "Size", lsize, rsize);
 	else
 	{
-		const auto s = reinterpret_cast<uint8_t *>(m_Begin);
-		const auto d = reinterpret_cast<uint8_t *>(r.m_Begin);
-		for (auto i = 0; i < m_Size; ++i)
-			if (s[i] != d[i])
-			{
-				out << std::setw(depth * 4) << ' ' << "Offset[" << i << "]" << std::endl;
-				break;
-			}
+		auto mismatch = CompareBytes(l, r, lsize);
+		if (!mismatch.Equal())
+			report.Add(DiffRecord::Kind::Offset, depth, "Offset", std::to_string(mismatch.first));
 	}
 }
 
+hash_t Stream::Hash() const
+{
+	return m_Hash.Get([this] { return PDF::Hash(GetData(), m_Size); });
+}
+
 std::string Stream::Display() const noexcept
 {
-	auto s = std::stringstream();
-	s << std::hex << m_Begin << '-' << std::hex << (m_Begin + m_Size);
-	return s.str();
+	auto s = std::string();
+	Printer(s).Print(*this);
+	return s;
 }
 
 /******************************************************************************
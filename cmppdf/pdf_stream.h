@@ -1,33 +1,59 @@
 #pragma once
 
+#include "pdf_hash.h"
 #include <iomanip>
 #include <cstdint>
 #include <cstring>
 
 namespace PDF
 {
+	class DiffReport;
+
 	class Stream
 	{
 	public:
 		Stream() : m_Begin(0), m_Size(0) {}
 		Stream(uintptr_t begin, size_t size) : m_Begin(begin), m_Size(size) {}
-		Stream(const Stream &r) : m_Begin(r.m_Begin), m_Size(r.m_Size) {}
-		Stream(Stream &&r) : m_Begin(r.m_Begin), m_Size(r.m_Size) {}
+		Stream(const Stream &r) : m_Begin(r.m_Begin), m_Size(r.m_Size), m_Hash(r.m_Hash) {}
+		Stream(Stream &&r) : m_Begin(r.m_Begin), m_Size(r.m_Size), m_Hash(r.m_Hash) {}
 
 		Stream &operator=(const Stream &r);
 		Stream &operator=(Stream &&r);
 
 		bool operator==(const Stream &r) const noexcept;
 		bool operator!=(const Stream &r) const noexcept { return !(*this == r); }
-		void diff(std::ostream &out, const Stream &r, size_t depth = 0) const noexcept;
-
+		void diff(DiffReport &report, const Stream &r, size_t depth = 0) const noexcept;
+
+		/**
+		 * Hash of the raw bytes, read once and then reused by every comparison.
+		 */
+		hash_t Hash() const;
+
+		/**
+		 * Make diff list every changed byte range, coalescing ranges at most
+		 * `granularity` bytes apart, instead of only the first differing offset.
+		 */
+		static void SetRangeGranularity(size_t granularity) noexcept { s_Granularity = granularity; }
+		static bool ReportsRanges() noexcept { return s_Granularity != first_only; }
+
+		/**
+		 * Report the difference of two byte ranges as diff does for stream
+		 * contents, e.g. for decoded ones.
+		 */
+		static void DiffBytes(DiffReport &report, const char *l, size_t lsize, const char *r, size_t rsize, size_t depth) noexcept;
+
+		const char *GetData() const noexcept { return reinterpret_cast<const char *>(m_Begin); }
 		size_t GetSize() const noexcept { return m_Size; }
 
 		std::string Display() const noexcept;
 
 	private:
+		static constexpr size_t first_only = SIZE_MAX;
+		static size_t s_Granularity;
+
 		uintptr_t m_Begin;
 		size_t m_Size;
+		HashCache m_Hash;
 	};
 }
 
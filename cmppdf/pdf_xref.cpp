@@ -1,25 +1,127 @@
 #include "pdf_xref.h"
+#include "pdf_printer.h"
 
 using namespace PDF;
 
-void Xref::diff(std::ostream &out, const Xref &r, size_t depth) const
+static bool has_stream(const Xref &xref) { return xref.object == Object::Type::DICTIONARY && xref.object.HasKey(Name::Length); }
+
+static bool same_decoded(const Xref &l, const Xref &r, const resolver_t &lresolve, const resolver_t &rresolve)
+{
+	try
+	{
+		auto ld = OpenDecoder(l.object, l.stream, true, lresolve);
+		auto rd = OpenDecoder(r.object, r.stream, true, rresolve);
+		return CompareDecoded(*ld, *rd).Equal();
+	}
+	catch (const std::exception &)
+	{
+		// Undecodable data can still be compared as it is.
+		return l.stream == r.stream;
+	}
+}
+
+hash_t Xref::Hash() const
+{
+	return hash.Get([this] {
+		auto h = HashCombine(hash_t(revision), used);
+		h = HashCombine(h, object.Hash());
+		return HashCombine(h, stream.Hash());
+	});
+}
+
+hash_t Xref::DecodedHash(const resolver_t &resolve) const
+{
+	if (!has_stream(*this))
+		return Hash();
+
+	auto h = HashCombine(hash_t(revision), used);
+	h = HashCombine(h, object.GetDictionary().Hash(EncodingKeys));
+	try
+	{
+		// Chunks are full except the last one, so the result only depends on the content.
+		auto decoder = OpenDecoder(object, stream, true, resolve);
+		auto buffer = std::vector<char>(64 * 1024);
+		for (auto size = size_t(0); (size = decoder->Read(buffer.data(), buffer.size())) != 0;)
+			h = HashCombine(h, PDF::Hash(buffer.data(), size));
+		return h;
+	}
+	catch (const std::exception &)
+	{
+		// Undecodable data counts as it is, as in same_decoded.
+		return HashCombine(~h, stream.Hash());
+	}
+}
+
+static void diff_decoded(DiffReport &report, const Xref &l, const Xref &r, size_t depth, const resolver_t &lresolve, const resolver_t &rresolve)
+{
+	try
+	{
+		if (Stream::ReportsRanges())
+		{
+			// Realigning needs random access to both sides, so these are decoded in full.
+			auto ld = Decode(l.object, l.stream, true, lresolve);
+			auto rd = Decode(r.object, r.stream, true, rresolve);
+			Stream::DiffBytes(report, ld.data(), ld.size(), rd.data(), rd.size(), depth);
+			return;
+		}
+		auto ld = OpenDecoder(l.object, l.stream, true, lresolve);
+		auto rd = OpenDecoder(r.object, r.stream, true, rresolve);
+		auto mismatch = CompareDecoded(*ld, *rd, true);
+		if (mismatch.left_size != mismatch.right_size)
+			report.Changed(depth, "Size", mismatch.left_size, mismatch.right_size);
+		else if (!mismatch.Equal())
+			report.Add(DiffRecord::Kind::Offset, depth, "Offset", std::to_string(mismatch.first));
+	}
+	catch (const std::exception &e)
+	{
+		report.Add(DiffRecord::Kind::Note, depth, "Not decodable", e.what());
+		l.stream.diff(report, r.stream, depth);
+	}
+}
+
+bool Xref::Equal(const Xref &r, bool decoded, const resolver_t &lresolve, const resolver_t &rresolve) const
+{
+	if (!decoded || !has_stream(*this) || !has_stream(r))
+		return *this == r;
+	return revision == r.revision && used == r.used &&
+		   object.GetDictionary().Equal(r.object.GetDictionary(), EncodingKeys) && same_decoded(*this, r, lresolve, rresolve);
+}
+
+void Xref::diff(DiffReport &report, const Xref &r, size_t depth, bool decoded, const resolver_t &lresolve, const resolver_t &rresolve) const
 {
 	// if (offset != r.offset)
-	// 	out << std::setw(depth * 4) << ' ' << "Offset: " << offset << " / " << r.offset << std::endl;
+	// 	report.Changed(depth, "Offset", offset, r.offset);
 	if (revision != r.revision)
-		out << std::setw(depth * 4) << ' ' << "Revision: " << revision << " / " << r.revision << std::endl;
+		report.Changed(depth, "Revision", revision, r.revision);
 	if (used != r.used)
-		out << std::setw(depth * 4) << ' ' << "Used: " << used << " / " << r.used << std::endl;
+		report.Changed(depth, "Used", used, r.used);
+
+	if (decoded && has_stream(*this) && has_stream(r))
+	{
+		const auto &ldic = object.GetDictionary();
+		const auto &rdic = r.object.GetDictionary();
+		if (!ldic.Equal(rdic, EncodingKeys))
+		{
+			report.Add(DiffRecord::Kind::Group, depth, "Object");
+			ldic.diff(report, rdic, depth + 1, EncodingKeys);
+		}
+		if (!same_decoded(*this, r, lresolve, rresolve))
+		{
+			report.Add(DiffRecord::Kind::Group, depth, "Decoded stream");
+			diff_decoded(report, *this, r, depth + 1, lresolve, rresolve);
+		}
+		return;
+	}
 
 	if (object != r.object)
 	{
-		out << std::setw(depth * 4) << ' ' << "Object: " << std::endl;
-		object.diff(out, r.object, depth + 1);
+		report.Add(DiffRecord::Kind::Group, depth, "Object");
+		object.diff(report, r.object, depth + 1);
 	}
 	if (stream != r.stream)
 	{
-		out << std::setw(depth * 4) << ' ' << "Stream: " << std::endl;
-		stream.diff(out, r.stream, depth + 1);
+		report.Add(DiffRecord::Kind::Group, depth, "Stream");
+		stream.diff(report, r.stream, depth + 1);
 	}
 }
 
@@ -29,8 +131,7 @@ void Xref::diff(std::ostream &out, const Xref &r, size_t depth) const
 
 std::ostream &operator<<(std::ostream &out, const PDF::Xref &xref)
 {
-	out << std::setw(10) << xref.offset << ' ' << std::setw(5) << xref.revision << ' ' << std::setw(6) << (xref.used ? "use" : "unused") << ' ' << xref.object;
-	if (xref.stream.GetSize() > 0)
-		out << " stream[" << xref.stream.GetSize() << "]";
-	return out;
+	auto s = std::string();
+	Printer(s).Print(xref);
+	return out << s;
 }
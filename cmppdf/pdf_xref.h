@@ -1,6 +1,8 @@
 #pragma once
 
+#include "pdf_filter.h"
 #include "pdf_object.h"
+#include "pdf_report.h"
 
 namespace PDF
 {
@@ -10,13 +12,37 @@ namespace PDF
 		int revision = 0;
 		bool used = 0;
 
+		// Compressed object (PDF 1.5): stored at `index` in object stream `container` instead of at `offset`.
+		indirect_t container = 0;
+		size_t index = 0;
+
+		bool loaded = false;
 		Object object;
 		stream_t stream;
 
+		// Cached hash of revision, used, object and stream; reset when the entry is (re)loaded.
+		HashCache hash;
+
+		// Field by field, so that a size mismatch never hashes a stream.
 		bool operator==(const Xref &r) const { return /*offset == r.offset &&*/ revision == r.revision && used == r.used && object == r.object && stream == r.stream; }
 		bool operator!=(const Xref &r) const { return !(*this == r); }
 
-		void diff(std::ostream &out, const Xref &r, size_t depth = 0) const;
+		/**
+		 * With `decoded`, streams are compared by their filtered content, and
+		 * the dictionary keys that only describe the encoding are skipped.
+		 * Indirect filter entries are looked up with the resolver of each
+		 * side's document.
+		 */
+		bool Equal(const Xref &r, bool decoded, const resolver_t &lresolve = nullptr, const resolver_t &rresolve = nullptr) const;
+
+		void diff(DiffReport &report, const Xref &r, size_t depth = 0, bool decoded = false, const resolver_t &lresolve = nullptr, const resolver_t &rresolve = nullptr) const;
+		hash_t Hash() const;
+
+		/**
+		 * Hash that follows Equal(r, true): streams count by their decoded
+		 * content and without the encoding keys. Decodes on every call.
+		 */
+		hash_t DecodedHash(const resolver_t &resolve = nullptr) const;
 	};
 }
 
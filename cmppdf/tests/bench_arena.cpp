@@ -0,0 +1,59 @@
+#include "pdf.h"
+#include "sample.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+
+using namespace PDF;
+
+namespace
+{
+	std::atomic<size_t> heap_allocations{0};
+}
+
+// Every heap allocation of the process is counted, the arena's chunks included.
+void *operator new(size_t size)
+{
+	++heap_allocations;
+	if (auto p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+/**
+ * usage > bench_arena [pages]
+ * Heap allocations, arena use and the time to parse and to release a
+ * generated document with every object loaded.
+ */
+int main(int argc, char *argv[])
+{
+	auto pages = size_t(argc > 1 ? std::stoul(argv[1]) : 10000);
+	auto file = Sample::TempFile(Sample::Pages(pages));
+
+	auto options = Options();
+	options.eager = true;
+
+	auto before = heap_allocations.load();
+	auto begin = std::chrono::steady_clock::now();
+	auto doc = std::make_unique<Document>(file.Path(), options);
+	auto parse = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	auto allocations = heap_allocations - before;
+
+	const auto &arena = doc->GetArena();
+	std::cout << pages << " pages, " << doc->GetStatistics().objects << " objects" << std::endl
+			  << "parse: " << parse * 1000 << " ms" << std::endl
+			  << "heap allocations: " << allocations << std::endl
+			  << "arena allocations: " << arena.GetAllocations() << " (" << arena.GetBytes() << " bytes in " << arena.GetChunks() << " chunks)" << std::endl;
+
+	begin = std::chrono::steady_clock::now();
+	doc.reset();
+	std::cout << "release: " << std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count() * 1000 << " ms" << std::endl;
+	return 0;
+}
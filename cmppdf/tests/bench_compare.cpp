@@ -0,0 +1,59 @@
+#include "pdf_compare.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace PDF;
+
+namespace
+{
+	/**
+	 * GB/s of `f` over `size` bytes, repeated until it has run long enough
+	 * to be timed.
+	 */
+	template <typename F>
+	double throughput(size_t size, F &&f)
+	{
+		auto runs = size_t(0);
+		auto begin = std::chrono::steady_clock::now();
+		auto seconds = 0.0;
+		do
+		{
+			f();
+			++runs;
+			seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		} while (seconds < 0.2);
+		return double(size) * double(runs) / seconds / 1e9;
+	}
+}
+
+/**
+ * usage > bench_compare [max MB]
+ * CompareBytes against memcmp on equal-sized buffers from 1 KB up to
+ * `max MB` (64 by default; 1024 for 1 GB), differing in the last byte
+ * only, so that every byte is read.
+ */
+int main(int argc, char *argv[])
+{
+	auto max = size_t(argc > 1 ? std::stoul(argv[1]) : 64) << 20;
+	auto l = std::vector<char>(max, 'x');
+	auto r = l;
+	auto sink = size_t(0);
+
+	std::cout << "kernel: " << CompareBytesKernel() << std::endl
+			  << "size, memcmp GB/s, CompareBytes GB/s, with ranges GB/s" << std::endl;
+	for (auto size = size_t(1024); size <= max; size *= 4)
+	{
+		r[size - 1] = 'y';
+		auto libc = throughput(size, [&] { sink += std::memcmp(l.data(), r.data(), size) != 0; });
+		auto first = throughput(size, [&] { sink += CompareBytes(l.data(), r.data(), size).first; });
+		auto ranges = throughput(size, [&] { sink += CompareBytes(l.data(), r.data(), size, true).ranges; });
+		r[size - 1] = 'x';
+
+		auto label = size < (1 << 20) ? std::to_string(size >> 10) + " KB" : std::to_string(size >> 20) + " MB";
+		std::cout << label << ", " << libc << ", " << first << ", " << ranges << std::endl;
+	}
+	return sink ? 0 : 1;
+}
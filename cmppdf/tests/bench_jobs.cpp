@@ -0,0 +1,38 @@
+#include "pdf.h"
+#include "sample.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using namespace PDF;
+
+/**
+ * usage > bench_jobs [pages]
+ * Eager open of a generated document with 1, 2, 4, 8 and 16 pre-decoding
+ * threads, once with a cross-reference table and once with object streams.
+ */
+int main(int argc, char *argv[])
+{
+	auto pages = size_t(argc > 1 ? std::stoul(argv[1]) : 20000);
+	for (auto format : {Sample::Writer::Xref::Table, Sample::Writer::Xref::Stream})
+	{
+		auto file = Sample::TempFile(Sample::Pages(pages, format));
+		std::cout << (format == Sample::Writer::Xref::Table ? "xref table" : "object streams") << ", " << pages << " pages" << std::endl;
+
+		auto single = 0.0;
+		for (auto jobs : {1, 2, 4, 8, 16})
+		{
+			auto options = Options();
+			options.eager = true;
+			options.jobs = size_t(jobs);
+
+			auto begin = std::chrono::steady_clock::now();
+			auto doc = Document(file.Path(), options);
+			auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+			if (jobs == 1)
+				single = seconds;
+			std::cout << "  jobs " << jobs << ": " << seconds * 1000 << " ms, " << size_t(double(doc.GetStatistics().objects) / seconds) << " objects/s, x" << single / seconds << std::endl;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,60 @@
+#include "pdf.h"
+#include "sample.h"
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+using namespace PDF;
+
+namespace
+{
+	double seconds_since(std::chrono::steady_clock::time_point begin)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	}
+
+	void line(const char *what, double count, const char *unit, double seconds)
+	{
+		std::cout << what << ": " << size_t(count / seconds) << ' ' << unit << "/s (" << seconds * 1000 << " ms)" << std::endl;
+	}
+}
+
+/**
+ * usage > bench_lexer [pages]
+ * Lexer and parser throughput on a generated document: cross-reference
+ * rows, objects and content stream tokens.
+ */
+int main(int argc, char *argv[])
+{
+	auto pages = size_t(argc > 1 ? std::stoul(argv[1]) : 20000);
+	auto file = Sample::TempFile(Sample::Pages(pages));
+	auto size = double(std::filesystem::file_size(file.Path()));
+
+	// Opening lazily reads the cross-reference table and the trailer only.
+	auto begin = std::chrono::steady_clock::now();
+	auto lazy = Document(file.Path());
+	line("xref rows", double(lazy.GetXrefSize()), "rows", seconds_since(begin));
+
+	auto options = Options();
+	options.eager = true;
+	begin = std::chrono::steady_clock::now();
+	auto doc = Document(file.Path(), options);
+	auto elapsed = seconds_since(begin);
+	line("objects", double(doc.GetStatistics().objects), "objects", elapsed);
+	line("bytes", size / 1e6, "MB", elapsed);
+
+	auto content = std::string();
+	for (auto i = size_t(0); i < doc.GetPageCount(); ++i)
+	{
+		const auto &xref = doc.GetXref(size_t(doc.GetPage(i).obj_no));
+		const auto &stream = doc.GetXref(size_t(xref.object[Name::Contents].GetIndirect())).stream;
+		content.append(stream.GetData(), stream.GetSize());
+	}
+	begin = std::chrono::steady_clock::now();
+	auto tokens = size_t(0);
+	for (auto lexer = ContentLexer(content); lexer.Next().kind != ContentLexer::Kind::End;)
+		++tokens;
+	line("content tokens", double(tokens), "tokens", seconds_since(begin));
+	return 0;
+}
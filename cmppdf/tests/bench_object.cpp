@@ -0,0 +1,87 @@
+#include "pdf.h"
+#include "sample.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+using namespace PDF;
+
+namespace
+{
+	// Resident set size in bytes, 0 where /proc is not available.
+	size_t resident()
+	{
+#ifdef __linux__
+		auto statm = std::ifstream("/proc/self/statm");
+		auto pages = size_t(0), rss = size_t(0);
+		if (statm >> pages >> rss)
+			return rss * size_t(sysconf(_SC_PAGESIZE));
+#endif
+		return 0;
+	}
+
+	template <typename F>
+	void measure(const char *what, size_t count, F &&f)
+	{
+		auto begin = std::chrono::steady_clock::now();
+		f();
+		auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		std::cout << what << ": " << size_t(double(count) / seconds) << " objects/s" << std::endl;
+	}
+}
+
+/**
+ * usage > bench_object [pages] [rounds]
+ * Size of an Object, resident memory per parsed object, and copy, move
+ * and compare throughput over the objects of a generated document.
+ */
+int main(int argc, char *argv[])
+{
+	auto pages = size_t(argc > 1 ? std::stoul(argv[1]) : 20000);
+	auto rounds = size_t(argc > 2 ? std::stoul(argv[2]) : 20);
+	auto file = Sample::TempFile(Sample::Pages(pages));
+
+	auto options = Options();
+	options.eager = true;
+	auto before = resident();
+	auto doc = Document(file.Path(), options);
+	auto objects = size_t(doc.GetStatistics().objects);
+	std::cout << "sizeof(Object): " << sizeof(Object) << std::endl
+			  << "resident per object, file image included: " << (resident() - before) / objects << " bytes (" << doc.GetArena().GetBytes() / objects << " in the arena)" << std::endl;
+
+	auto source = std::vector<Object>();
+	for (auto i = size_t(1); i < doc.GetXrefSize(); ++i)
+		source.push_back(doc.GetXref(i).object);
+	auto total = source.size() * rounds;
+
+	auto copies = std::vector<Object>(source.size());
+	measure("copy", total, [&] {
+		for (auto round = size_t(0); round < rounds; ++round)
+			for (auto i = size_t(0); i < source.size(); ++i)
+				copies[i] = source[i];
+	});
+
+	measure("move", total, [&] {
+		for (auto round = size_t(0); round < rounds; ++round)
+		{
+			auto moved = std::vector<Object>();
+			moved.reserve(copies.size());
+			for (auto &obj : copies)
+				moved.push_back(std::move(obj));
+			copies.swap(moved);
+		}
+	});
+
+	auto equal = size_t(0);
+	measure("compare", total, [&] {
+		for (auto round = size_t(0); round < rounds; ++round)
+			for (auto i = size_t(0); i < source.size(); ++i)
+				equal += source[i] == copies[i];
+	});
+	return equal == total ? 0 : 1;
+}
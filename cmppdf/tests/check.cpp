@@ -0,0 +1,60 @@
+#include "check.h"
+#include <exception>
+#include <iostream>
+#include <string_view>
+
+std::vector<Check::Case> &Check::Cases()
+{
+	static auto cases = std::vector<Case>();
+	return cases;
+}
+
+void Check::Fail(const char *file, int line, const std::string &message)
+{
+	throw failure(std::string(file) + ":" + std::to_string(line) + ": " + message);
+}
+
+/**
+ * usage > cmppdf_tests [suite...]
+ * Runs every case of the given suites, or all of them; exits with the
+ * number of failed cases.
+ */
+int main(int argc, char *argv[])
+{
+	auto selected = [&](const char *suite) {
+		if (argc < 2)
+			return true;
+		for (auto i = 1; i < argc; ++i)
+			if (std::string_view(argv[i]) == suite)
+				return true;
+		return false;
+	};
+
+	auto run = 0;
+	auto failed = 0;
+	for (const auto &test : Check::Cases())
+	{
+		if (!selected(test.suite))
+			continue;
+		++run;
+		try
+		{
+			test.run();
+			std::cout << "ok     " << test.suite << '.' << test.name << std::endl;
+		}
+		catch (const std::exception &e)
+		{
+			++failed;
+			std::cout << "FAILED " << test.suite << '.' << test.name << std::endl
+					  << "    " << e.what() << std::endl;
+		}
+	}
+
+	if (!run)
+	{
+		std::cerr << "no such suite." << std::endl;
+		return 1;
+	}
+	std::cout << run - failed << " of " << run << " passed" << std::endl;
+	return failed;
+}
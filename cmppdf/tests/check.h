@@ -0,0 +1,74 @@
+#pragma once
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Just enough of a test framework: TEST(suite, name) registers a case, and
+ * the runner (check.cpp) runs the cases of the suites named on its command
+ * line. CHECK* throw on failure, so a case stops at the first one.
+ */
+namespace Check
+{
+	struct Case
+	{
+		const char *suite;
+		const char *name;
+		void (*run)();
+	};
+
+	std::vector<Case> &Cases();
+
+	struct Register
+	{
+		Register(const char *suite, const char *name, void (*run)()) { Cases().push_back({suite, name, run}); }
+	};
+
+	class failure : public std::runtime_error
+	{
+	public:
+		failure(const std::string &message) : std::runtime_error(message) {}
+	};
+
+	[[noreturn]] void Fail(const char *file, int line, const std::string &message);
+
+	template <typename L, typename R>
+	void Equal(const L &l, const R &r, const char *expression, const char *file, int line)
+	{
+		if (l == r)
+			return;
+		auto out = std::ostringstream();
+		out << expression << "\n      left: " << l << "\n     right: " << r;
+		Fail(file, line, out.str());
+	}
+}
+
+#define TEST(suite, name)                                                              \
+	static void suite##_##name();                                                      \
+	static const Check::Register suite##_##name##_registered(#suite, #name, suite##_##name); \
+	static void suite##_##name()
+
+#define CHECK(condition)                                      \
+	do                                                        \
+	{                                                         \
+		if (!(condition))                                     \
+			Check::Fail(__FILE__, __LINE__, #condition);      \
+	} while (false)
+
+#define CHECK_EQ(l, r) Check::Equal((l), (r), #l " == " #r, __FILE__, __LINE__)
+
+#define CHECK_THROWS(expression, type)                                          \
+	do                                                                          \
+	{                                                                           \
+		try                                                                     \
+		{                                                                       \
+			expression;                                                         \
+		}                                                                       \
+		catch (const type &)                                                    \
+		{                                                                       \
+			break;                                                              \
+		}                                                                       \
+		Check::Fail(__FILE__, __LINE__, #expression " does not throw " #type); \
+	} while (false)
@@ -0,0 +1,409 @@
+#include "sample.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <zlib.h>
+
+using namespace Sample;
+
+namespace
+{
+	std::string formatted(const char *pattern, size_t a, size_t b = 0, size_t c = 0, size_t d = 0, size_t e = 0, size_t f = 0, size_t g = 0)
+	{
+		char text[256];
+		auto n = std::snprintf(text, sizeof(text), pattern, a, b, c, d, e, f, g);
+		return std::string(text, size_t(n));
+	}
+
+	std::string ref(size_t obj_no) { return std::to_string(obj_no) + " 0 R"; }
+
+	/**
+	 * Runs of consecutive object numbers: begin, count, begin, count, ...
+	 */
+	template <typename T>
+	std::vector<size_t> runs(const std::vector<T> &sorted)
+	{
+		auto result = std::vector<size_t>();
+		for (const auto &entry : sorted)
+		{
+			if (!result.empty() && result[result.size() - 2] + result.back() == entry.obj_no)
+				++result.back();
+			else
+			{
+				result.push_back(entry.obj_no);
+				result.push_back(1);
+			}
+		}
+		return result;
+	}
+}
+
+TempFile::TempFile(std::string_view data)
+{
+	auto random = std::random_device();
+	auto name = "cmppdf-test-" + std::to_string(random()) + std::to_string(random()) + ".pdf";
+	m_Path = (std::filesystem::temp_directory_path() / name).string();
+	auto out = std::ofstream(m_Path, std::ios::binary);
+	out.write(data.data(), std::streamsize(data.size()));
+	if (!out)
+		throw std::runtime_error("cannot write " + m_Path);
+}
+
+TempFile::~TempFile()
+{
+	auto error = std::error_code();
+	std::filesystem::remove(m_Path, error);
+}
+
+/******************************************************************************
+
+******************************************************************************/
+
+Writer::Writer(std::string_view version)
+{
+	m_Data.append("%PDF-").append(version).append("\n%\xe2\xe3\xcf\xd3\n");
+}
+
+size_t Writer::Begin(size_t obj_no)
+{
+	if (!obj_no)
+		obj_no = Reserve();
+	m_Next = std::max(m_Next, obj_no + 1);
+	m_Entries.push_back(Entry{obj_no, m_Data.size(), 0, 0});
+	m_Data += std::to_string(obj_no) + " 0 obj\n";
+	return obj_no;
+}
+
+size_t Writer::Add(std::string_view body, size_t obj_no)
+{
+	obj_no = Begin(obj_no);
+	m_Data.append(body).append("\nendobj\n");
+	return obj_no;
+}
+
+size_t Writer::AddStream(std::string_view entries, std::string_view data, size_t obj_no)
+{
+	obj_no = Begin(obj_no);
+	m_Data += "<< /Length " + std::to_string(data.size());
+	if (!entries.empty())
+		m_Data.append(" ").append(entries);
+	m_Data.append(" >>\nstream\n").append(data).append("\nendstream\nendobj\n");
+	return obj_no;
+}
+
+size_t Writer::AddFlateStream(std::string_view entries, std::string_view data, size_t obj_no)
+{
+	auto all = std::string("/Filter /FlateDecode");
+	if (!entries.empty())
+		all.append(" ").append(entries);
+	return AddStream(all, Flate(data), obj_no);
+}
+
+size_t Writer::AddObjectStream(const std::vector<std::pair<size_t, std::string>> &objects, size_t obj_no, std::string_view filter)
+{
+	// The header is N pairs of object number and offset relative to /First.
+	auto header = std::string();
+	auto bodies = std::string();
+	for (const auto &object : objects)
+	{
+		header += std::to_string(object.first) + " " + std::to_string(bodies.size()) + " ";
+		bodies += object.second + "\n";
+	}
+	auto entries = "/Filter " + std::string(filter) + " /Type /ObjStm /N " + std::to_string(objects.size()) + " /First " + std::to_string(header.size());
+	obj_no = AddStream(entries, Flate(header + bodies), obj_no);
+
+	for (auto i = size_t(0); i < objects.size(); ++i)
+	{
+		m_Entries.push_back(Entry{objects[i].first, 0, obj_no, i});
+		m_Next = std::max(m_Next, objects[i].first + 1);
+	}
+	return obj_no;
+}
+
+void Writer::EndSection(size_t root, Xref format, std::string_view trailer)
+{
+	auto entries = std::string("/Root " + ref(root));
+	if (!m_First)
+		entries += " /Prev " + std::to_string(m_Prev);
+	if (!trailer.empty())
+		entries.append(" ").append(trailer);
+
+	auto by_number = [](const Entry &l, const Entry &r) { return l.obj_no < r.obj_no; };
+	auto offset = m_Data.size();
+	if (format == Xref::Table)
+	{
+		std::sort(m_Entries.begin(), m_Entries.end(), by_number);
+		m_Data += "xref\n";
+		if (m_First)
+			m_Data += "0 1\n0000000000 65535 f \n";
+		auto subsections = runs(m_Entries);
+		auto entry = m_Entries.begin();
+		for (auto i = size_t(0); i < subsections.size(); i += 2)
+		{
+			m_Data += formatted("%zu %zu\n", subsections[i], subsections[i + 1]);
+			for (auto n = size_t(0); n < subsections[i + 1]; ++n, ++entry)
+			{
+				if (entry->container)
+					throw std::logic_error("compressed objects need a cross-reference stream.");
+				m_Data += formatted("%010zu 00000 n \n", entry->offset);
+			}
+		}
+		m_Data += "trailer\n<< /Size " + std::to_string(m_Next) + " " + entries + " >>\n";
+	}
+	else
+	{
+		// The stream lists itself; W [1 4 2]: type, offset or object stream, generation or index.
+		auto obj_no = Reserve();
+		m_Entries.push_back(Entry{obj_no, offset, 0, 0});
+		if (m_First)
+			m_Entries.push_back(Entry{0, 0, 0, 65535});
+		std::sort(m_Entries.begin(), m_Entries.end(), by_number);
+
+		auto data = std::string();
+		auto put = [&data](size_t value, size_t width) {
+			for (auto i = width; i-- > 0;)
+				data += char((value >> (8 * i)) & 0xff);
+		};
+		for (const auto &entry : m_Entries)
+		{
+			put(!entry.obj_no ? 0 : entry.container ? 2 : 1, 1);
+			put(entry.container ? entry.container : entry.offset, 4);
+			put(entry.index, 2);
+		}
+
+		auto index = std::string();
+		for (auto run : runs(m_Entries))
+			index += std::to_string(run) + " ";
+		AddStream("/Type /XRef /Size " + std::to_string(m_Next) + " /W [1 4 2] /Index [" + index + "] " + entries, data, obj_no);
+	}
+	m_Data += "startxref\n" + std::to_string(offset) + "\n%%EOF\n";
+
+	m_Prev = offset;
+	m_First = false;
+	m_Entries.clear();
+}
+
+std::string Sample::Flate(std::string_view data)
+{
+	auto size = compressBound(uLong(data.size()));
+	auto out = std::string(size, '\0');
+	if (compress2(reinterpret_cast<Bytef *>(&out[0]), &size, reinterpret_cast<const Bytef *>(data.data()), uLong(data.size()), Z_BEST_SPEED) != Z_OK)
+		throw std::runtime_error("compress2 failed.");
+	out.resize(size);
+	return out;
+}
+
+/******************************************************************************
+
+******************************************************************************/
+
+std::string Sample::Pages(size_t pages, Writer::Xref format)
+{
+	auto compressed = format == Writer::Xref::Stream;
+	auto w = Writer(compressed ? "1.5" : "1.4");
+	auto catalog = w.Reserve();
+	auto root = w.Reserve();
+	auto f1 = w.Add("<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>");
+	auto f2 = w.Add("<< /Type /Font /Subtype /Type1 /BaseFont /Times-Roman >>");
+	auto resources = w.Add("<< /Font << /F1 " + ref(f1) + " /F2 " + ref(f2) + " >> /ProcSet [/PDF /Text] >>");
+
+	auto kids = std::string();
+	auto batch = std::vector<std::pair<size_t, std::string>>();
+	for (auto i = size_t(0); i < pages; ++i)
+	{
+		auto content = w.AddStream("", formatted("BT /F%zu 12 Tf 72 %zu Td (Page %zu) Tj ET\n0 0 1 rg 10 10 100 50 re f\n", 1 + i % 2, 700 - i % 50, i));
+		auto page = "<< /Type /Page /Parent " + ref(root) + " /Resources " + ref(resources) + " /MediaBox [0 0 612 792] /Contents " + ref(content) + " >>";
+		auto obj_no = compressed ? w.Reserve() : w.Add(page);
+		kids += ref(obj_no) + " ";
+
+		if (compressed)
+		{
+			batch.emplace_back(obj_no, page);
+			if (batch.size() == 100)
+			{
+				w.AddObjectStream(batch);
+				batch.clear();
+			}
+		}
+	}
+	if (!batch.empty())
+		w.AddObjectStream(batch);
+
+	w.Add("<< /Type /Pages /Kids [" + kids + "] /Count " + std::to_string(pages) + " >>", root);
+	w.Add("<< /Type /Catalog /Pages " + ref(root) + " >>", catalog);
+	w.EndSection(catalog, format);
+	return w.Data();
+}
+
+/******************************************************************************
+
+******************************************************************************/
+
+namespace
+{
+	/**
+	 * Big-endian bit fields of a hint table (F.4).
+	 */
+	class Bits
+	{
+	public:
+		void Put(size_t value, size_t bits)
+		{
+			for (auto i = bits; i-- > 0;)
+			{
+				if (m_Used % 8 == 0)
+					m_Data += '\0';
+				if ((value >> i) & 1)
+					m_Data.back() |= char(0x80 >> (m_Used % 8));
+				++m_Used;
+			}
+		}
+
+		// Every table starts on a byte boundary.
+		const std::string &Data() const noexcept { return m_Data; }
+
+	private:
+		std::string m_Data;
+		size_t m_Used = 0;
+	};
+
+	/**
+	 * Where the pieces of a linearized file landed; written again until they
+	 * stop moving, because the first page section records them.
+	 */
+	struct Layout
+	{
+		size_t length = 0;		// L
+		size_t hint_offset = 0; // H
+		size_t hint_length = 0;
+		size_t first_page_end = 0; // E
+		size_t main_xref = 0;	   // T
+		std::vector<size_t> page_offsets;
+		std::vector<size_t> page_lengths;
+
+		bool operator==(const Layout &r) const
+		{
+			return length == r.length && hint_offset == r.hint_offset && hint_length == r.hint_length && first_page_end == r.first_page_end && main_xref == r.main_xref;
+		}
+	};
+
+	/**
+	 * F.3 Page offset hint table, with an empty shared object hint table.
+	 * Offsets count as if the hint stream were not there (F.4).
+	 */
+	std::pair<std::string, size_t> hint_table(const Layout &layout, bool broken)
+	{
+		auto least = *std::min_element(layout.page_lengths.begin(), layout.page_lengths.end());
+		auto most = *std::max_element(layout.page_lengths.begin(), layout.page_lengths.end());
+		auto length_bits = size_t(1);
+		while ((most - least) >> length_bits)
+			++length_bits;
+		auto first = layout.page_offsets[0];
+		if (first >= layout.hint_offset)
+			first -= layout.hint_length;
+		if (broken)
+			first += 7;
+
+		auto bits = Bits();
+		const size_t header[][2] = {
+			{2, 32}, {first, 32}, {0, 16}, {least, 32}, {length_bits, 16}, {0, 32}, {0, 16}, {0, 32}, {0, 16}, {0, 16}, {0, 16}, {0, 16}, {1, 16}};
+		for (const auto &item : header)
+			bits.Put(item[0], item[1]);
+		// Item 1 (objects per page) takes no bits: every page has two.
+		for (auto length : layout.page_lengths)
+			bits.Put(length - least, length_bits);
+
+		auto table = bits.Data();
+		auto shared = table.size();
+		table.append(22, '\0');
+		return {table, shared};
+	}
+}
+
+std::string Sample::Linearized(size_t pages, bool broken_hints)
+{
+	// Pages after the first and the document information go first in the
+	// numbering (the main section), the first page section after them.
+	auto main_size = 2 * (pages - 1) + 2;
+	auto info = main_size - 1;
+	auto lin = main_size, cat = main_size + 1, root = main_size + 2, f1 = main_size + 3, f2 = main_size + 4, res = main_size + 5, hint = main_size + 6, p1 = main_size + 7, c1 = main_size + 8;
+	auto size = main_size + 9;
+	auto page_no = [&](size_t i) { return i ? 1 + 2 * (i - 1) : p1; };
+	auto content_no = [&](size_t i) { return i ? 2 + 2 * (i - 1) : c1; };
+
+	auto build = [&](const Layout &previous, const std::pair<std::string, size_t> &hints, Layout &layout) {
+		auto out = std::string("%PDF-1.5\n%\xe2\xe3\xcf\xd3\n");
+		auto offsets = std::vector<size_t>(size);
+		auto object = [&](size_t obj_no, const std::string &body) {
+			offsets[obj_no] = out.size();
+			out += std::to_string(obj_no) + " 0 obj\n" + body + "\nendobj\n";
+		};
+		auto stream = [](const std::string &entries, const std::string &data) {
+			auto deflated = Flate(data);
+			return "<< /Length " + std::to_string(deflated.size()) + " /Filter /FlateDecode " + entries + " >>\nstream\n" + deflated + "\nendstream";
+		};
+
+		object(lin, formatted("<< /Linearized 1 /L %010zu /H [ %010zu %010zu ] /O %zu /E %010zu /N %zu /T %010zu >>",
+						   previous.length, previous.hint_offset, previous.hint_length, p1, previous.first_page_end, pages, previous.main_xref));
+
+		auto first_xref = out.size();
+		out += formatted("xref\n%zu 9\n", main_size);
+		auto rows = out.size();
+		out.append(9 * 20, ' ');
+		out += formatted("trailer\n<< /Size %zu /Prev %010zu /Root %zu 0 R /Info %zu 0 R >>\nstartxref\n0\n%%%%EOF\n", size, previous.main_xref, cat, info);
+
+		auto kids = std::string();
+		for (auto i = size_t(0); i < pages; ++i)
+			kids += ref(page_no(i)) + " ";
+		object(cat, "<< /Type /Catalog /Pages " + ref(root) + " >>");
+		object(root, "<< /Type /Pages /Kids [" + kids + "] /Count " + std::to_string(pages) + " >>");
+		object(f1, "<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>");
+		object(f2, "<< /Type /Font /Subtype /Type1 /BaseFont /Times-Roman >>");
+		object(res, "<< /Font << /F1 " + ref(f1) + " /F2 " + ref(f2) + " >> /ProcSet [/PDF /Text] >>");
+		layout.hint_offset = out.size();
+		object(hint, stream("/S " + std::to_string(hints.second), hints.first));
+		layout.hint_length = out.size() - layout.hint_offset;
+
+		layout.page_offsets.clear();
+		for (auto i = size_t(0); i < pages; ++i)
+		{
+			layout.page_offsets.push_back(out.size());
+			object(page_no(i), "<< /Type /Page /Parent " + ref(root) + " /Resources " + ref(res) + " /MediaBox [0 0 612 792] /Contents " + ref(content_no(i)) + " >>");
+			object(content_no(i), stream("", formatted("BT /F1 12 Tf 72 %zu Td (Page %zu text) Tj ET\n0 0 1 rg 10 10 100 50 re f\nq 1 0 0 1 0 0 cm Q\n", 700 - i % 50, i)));
+		}
+		layout.first_page_end = pages > 1 ? layout.page_offsets[1] : out.size();
+		object(info, "<< /Producer (cmppdf tests) >>");
+
+		layout.main_xref = out.size();
+		out += formatted("xref\n0 %zu\n0000000000 65535 f \n", main_size);
+		for (auto obj_no = size_t(1); obj_no < main_size; ++obj_no)
+			out += formatted("%010zu 00000 n \n", offsets[obj_no]);
+		out += formatted("trailer\n<< /Size %zu >>\nstartxref\n%zu\n%%%%EOF\n", main_size, first_xref);
+
+		for (auto i = size_t(0); i < 9; ++i)
+			out.replace(rows + 20 * i, 20, formatted("%010zu 00000 n \n", offsets[main_size + i]));
+
+		layout.page_lengths.clear();
+		for (auto i = size_t(0); i < pages; ++i)
+			layout.page_lengths.push_back((i + 1 < pages ? layout.page_offsets[i + 1] : offsets[info]) - layout.page_offsets[i]);
+		layout.length = out.size();
+		return out;
+	};
+
+	// Every round records where the round before put things, until nothing moves.
+	auto previous = Layout();
+	auto hints = std::pair<std::string, size_t>(std::string(64, '\0'), 64);
+	for (auto round = 0; round < 16; ++round)
+	{
+		auto layout = Layout();
+		auto data = build(previous, hints, layout);
+		if (layout == previous)
+			return data;
+		hints = hint_table(layout, broken_hints);
+		previous = layout;
+	}
+	throw std::logic_error("linearized layout does not settle.");
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * PDF files generated for the tests and benchmarks, so that no binary
+ * samples have to be kept in the tree.
+ */
+namespace Sample
+{
+	/**
+	 * A file in the temporary directory, removed again on destruction.
+	 */
+	class TempFile
+	{
+	public:
+		explicit TempFile(std::string_view data);
+		~TempFile();
+
+		TempFile(const TempFile &) = delete;
+		TempFile &operator=(const TempFile &) = delete;
+
+		const std::string &Path() const noexcept { return m_Path; }
+
+	private:
+		std::string m_Path;
+	};
+
+	/**
+	 * Writes a PDF file object by object. A cross-reference section lists
+	 * the objects written since the section before it, so ending more than
+	 * one section makes incremental updates (3.4.5).
+	 */
+	class Writer
+	{
+	public:
+		enum class Xref
+		{
+			Table,	// 3.4.3 Cross-Reference Table
+			Stream, // 3.4.7 Cross-Reference Streams
+		};
+
+		explicit Writer(std::string_view version = "1.4");
+
+		// An object number to refer to before the object is written.
+		size_t Reserve() noexcept { return m_Next++; }
+
+		// Each returns the object number, a new one unless `obj_no` is given.
+		size_t Add(std::string_view body, size_t obj_no = 0);
+		size_t AddStream(std::string_view entries, std::string_view data, size_t obj_no = 0);
+		size_t AddFlateStream(std::string_view entries, std::string_view data, size_t obj_no = 0);
+
+		/**
+		 * An object stream (3.4.6) holding `objects`, pairs of object number
+		 * and body. They are compressed entries of the section, so it must be
+		 * ended with Xref::Stream. The data is deflated whatever `filter`
+		 * says; it is the value of /Filter, e.g. an indirect reference.
+		 */
+		size_t AddObjectStream(const std::vector<std::pair<size_t, std::string>> &objects, size_t obj_no = 0, std::string_view filter = "/FlateDecode");
+
+		/**
+		 * Cross-reference section and trailer; `trailer` holds extra entries
+		 * for the trailer dictionary.
+		 */
+		void EndSection(size_t root, Xref format = Xref::Table, std::string_view trailer = {});
+
+		const std::string &Data() const noexcept { return m_Data; }
+
+	private:
+		struct Entry
+		{
+			size_t obj_no;
+			size_t offset;
+			size_t container; // 0 unless compressed
+			size_t index;
+		};
+
+		std::string m_Data;
+		std::vector<Entry> m_Entries; // of the current section
+		size_t m_Next = 1;
+		size_t m_Prev = 0; // offset of the previous section
+		bool m_First = true;
+
+		size_t Begin(size_t obj_no);
+	};
+
+	std::string Flate(std::string_view data);
+
+	/**
+	 * A document of `pages` pages with a little text each, sharing one
+	 * resource dictionary with two fonts. With Xref::Stream the page
+	 * dictionaries are compressed into object streams of 100 objects.
+	 */
+	std::string Pages(size_t pages, Writer::Xref format = Writer::Xref::Table);
+
+	/**
+	 * A linearized document (Appendix F) with a page offset hint table.
+	 * `broken_hints` moves the first page in the table off its object.
+	 */
+	std::string Linearized(size_t pages, bool broken_hints = false);
+}
@@ -0,0 +1,52 @@
+#include "check.h"
+#include "pdf.h"
+#include "sample.h"
+#include <new>
+
+using namespace PDF;
+
+TEST(arena, no_scope)
+{
+	// Nothing would own the payload, so it is refused instead of leaked.
+	auto array = Array();
+	CHECK_THROWS(array.push_back(Object(1.0)), std::bad_alloc);
+	CHECK_THROWS(Object(Dictionary()).GetType(), std::bad_alloc);
+}
+
+TEST(arena, scopes)
+{
+	auto outer = Arena();
+	auto inner = Arena();
+	{
+		auto scope = Arena::Scope(outer);
+		CHECK(Arena::Current() == &outer);
+		{
+			auto nested = Arena::Scope(inner);
+			CHECK(Object(Array()) == Object::Type::ARRAY);
+			CHECK(Arena::Current() == &inner);
+		}
+		CHECK(Arena::Current() == &outer);
+		auto array = Array();
+		array.push_back(Object(2.0));
+		auto obj = Object(std::move(array));
+		CHECK_EQ(obj.GetArray().size(), size_t(1));
+	}
+	CHECK(Arena::Current() == std::pmr::null_memory_resource());
+	CHECK_EQ(inner.GetAllocations(), size_t(1));
+	CHECK(outer.GetAllocations() >= 2);
+}
+
+TEST(arena, document)
+{
+	// Loading opens a scope of its own, whatever the caller has open.
+	auto file = Sample::TempFile(Sample::Pages(5));
+	auto doc = Document(file.Path());
+	auto before = doc.GetArena().GetAllocations();
+	CHECK(doc.GetXref(doc.LocatePage(4)).object[Name::MediaBox] == Object::Type::ARRAY);
+	CHECK(doc.GetArena().GetAllocations() > before);
+
+	auto other = Arena();
+	auto scope = Arena::Scope(other);
+	CHECK(doc.GetXref(doc.LocatePage(3)).object[Name::Type] == Name::Page);
+	CHECK_EQ(other.GetAllocations(), size_t(0));
+}
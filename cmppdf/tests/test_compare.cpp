@@ -0,0 +1,244 @@
+#include "check.h"
+#include "pdf.h"
+#include "pdf_compare.h"
+#include "sample.h"
+#include <string>
+#include <vector>
+
+using namespace PDF;
+
+namespace
+{
+	std::vector<ByteRange> diff_ranges(const std::string &l, const std::string &r, size_t granularity = 0)
+	{
+		auto ranges = std::vector<ByteRange>();
+		DiffRanges(l.data(), l.size(), r.data(), r.size(), granularity, [&](const ByteRange &range) { ranges.push_back(range); });
+		return ranges;
+	}
+
+	std::string filler(size_t size)
+	{
+		auto data = std::string(size, '\0');
+		auto state = uint32_t(12345);
+		for (auto &c : data)
+		{
+			state = state * 1103515245 + 12345;
+			c = char(state >> 16);
+		}
+		return data;
+	}
+
+	std::string titled(std::string_view title, std::string_view version = "1.4")
+	{
+		auto w = Sample::Writer(version);
+		auto catalog = w.Add("<< /Type /Catalog /Pages 2 0 R >>");
+		w.Add("<< /Type /Pages /Kids [3 0 R] /Count 1 >>");
+		w.Add("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792] >>");
+		w.Add("<< /Title (" + std::string(title) + ") >>");
+		w.EndSection(catalog, Sample::Writer::Xref::Table, "/Info 4 0 R");
+		return w.Data();
+	}
+}
+
+TEST(compare, bytes)
+{
+	// Every size around the vector widths, a difference at every position.
+	for (auto size = size_t(0); size < 200; ++size)
+	{
+		auto l = filler(size);
+		CHECK(CompareBytes(l.data(), l.data(), size).Equal());
+		for (auto at = size_t(0); at < size; at += 7)
+		{
+			auto r = l;
+			r[at] = char(r[at] ^ 0x20);
+			auto mismatch = CompareBytes(l.data(), r.data(), size);
+			CHECK(!mismatch.Equal());
+			CHECK_EQ(mismatch.first, at);
+			CHECK_EQ(mismatch.ranges, size_t(1));
+		}
+	}
+	CHECK(CompareBytesKernel() != nullptr);
+}
+
+TEST(compare, byte_ranges)
+{
+	auto l = filler(1000);
+	auto r = l;
+	r[10] ^= 1;
+	r[11] ^= 1;
+	r[500] ^= 1;
+	r[999] ^= 1;
+	auto mismatch = CompareBytes(l.data(), r.data(), l.size(), true);
+	CHECK_EQ(mismatch.first, size_t(10));
+	CHECK_EQ(mismatch.ranges, size_t(3));
+}
+
+TEST(compare, diff_ranges_replace)
+{
+	auto l = filler(10000);
+	auto r = l;
+	r[100] ^= 1;
+	r[5000] ^= 1;
+	auto ranges = diff_ranges(l, r);
+	CHECK_EQ(ranges.size(), size_t(2));
+	CHECK_EQ(ranges[0].left, size_t(100));
+	CHECK_EQ(ranges[0].left_size, size_t(1));
+	CHECK_EQ(ranges[1].right, size_t(5000));
+
+	// Coalesced when closer than the granularity.
+	CHECK_EQ(diff_ranges(l, r, 10000).size(), size_t(1));
+	CHECK(diff_ranges(l, l).empty());
+}
+
+TEST(compare, diff_ranges_shift)
+{
+	// An insertion is reported as such, and the rest of the data realigns.
+	auto l = filler(100000);
+	auto r = l.substr(0, 30000) + "inserted" + l.substr(30000);
+	auto ranges = diff_ranges(l, r);
+	CHECK_EQ(ranges.size(), size_t(1));
+	CHECK_EQ(ranges[0].left, size_t(30000));
+	CHECK_EQ(ranges[0].left_size, size_t(0));
+	CHECK_EQ(ranges[0].right_size, size_t(8));
+
+	auto deleted = diff_ranges(r, l);
+	CHECK_EQ(deleted.size(), size_t(1));
+	CHECK_EQ(deleted[0].left_size, size_t(8));
+	CHECK_EQ(deleted[0].right_size, size_t(0));
+}
+
+TEST(compare, diff_ranges_sizes)
+{
+	auto l = filler(5000);
+	auto ranges = diff_ranges(l, l + "tail");
+	CHECK_EQ(ranges.size(), size_t(1));
+	CHECK_EQ(ranges[0].left, size_t(5000));
+	CHECK_EQ(ranges[0].right_size, size_t(4));
+
+	auto empty = diff_ranges("", l);
+	CHECK_EQ(empty.size(), size_t(1));
+	CHECK_EQ(empty[0].right_size, l.size());
+}
+
+TEST(compare, diff_ranges_realign)
+{
+	// Edits longer than the local resynchronization reaches, close enough
+	// together that the block index slides instead of being rebuilt; then
+	// the same over repeated content, where blocks share their hashes.
+	for (auto period : {size_t(0), size_t(4096)})
+	{
+		auto l = filler(period ? period : 300000);
+		while (l.size() < 300000)
+			l += l.substr(0, period);
+		auto r = l.substr(0, 20000) + std::string(100, 'z') + l.substr(20000, 40000) + std::string(100, 'y') +
+				 l.substr(60000, 1000) + std::string(100, 'x') + l.substr(61000, 189000) + l.substr(250050);
+
+		auto ranges = diff_ranges(l, r);
+		auto left = size_t(0);
+		auto right = size_t(0);
+		auto inserted = size_t(0);
+		auto deleted = size_t(0);
+		for (const auto &range : ranges)
+		{
+			// The bytes between two ranges are equal on both sides.
+			CHECK_EQ(range.left - left, range.right - right);
+			CHECK(l.compare(left, range.left - left, r, right, range.right - right) == 0);
+			left = range.left + range.left_size;
+			right = range.right + range.right_size;
+			inserted += range.right_size;
+			deleted += range.left_size;
+		}
+		CHECK(l.compare(left, std::string::npos, r, right, std::string::npos) == 0);
+		CHECK_EQ(ranges.size(), size_t(4));
+		CHECK_EQ(inserted, size_t(300));
+		CHECK_EQ(deleted, size_t(50));
+	}
+}
+
+TEST(compare, documents)
+{
+	auto first = Sample::TempFile(titled("first"));
+	auto copy = Sample::TempFile(titled("first"));
+	auto changed = Sample::TempFile(titled("other"));
+	auto version = Sample::TempFile(titled("first", "1.5"));
+	auto larger = Sample::TempFile(Sample::Pages(2));
+
+	auto doc = Document(first.Path());
+	CHECK(doc == doc);
+	CHECK(doc == Document(copy.Path()));
+	CHECK(!(doc == Document(changed.Path())));
+	CHECK(!(doc == Document(version.Path())));
+	CHECK(!(doc == Document(larger.Path())));
+}
+
+TEST(compare, fingerprints)
+{
+	auto first = Sample::TempFile(titled("first"));
+	auto copy = Sample::TempFile(titled("first"));
+	auto changed = Sample::TempFile(titled("other"));
+	auto larger = Sample::TempFile(Sample::Pages(2));
+
+	auto golden = Document(first.Path()).GetFingerprint();
+	CHECK(Document(copy.Path()).Matches(golden));
+	CHECK(!Document(changed.Path()).Matches(golden));
+	CHECK(!Document(larger.Path()).Matches(golden));
+
+	auto report = DiffReport();
+	Document(copy.Path()).diff(report, golden);
+	CHECK_EQ(report.size(), size_t(0));
+	Document(changed.Path()).diff(report, golden);
+	CHECK_EQ(report.size(), size_t(1));
+	CHECK_EQ(std::string(report[0].label), std::string("Xref table [4]"));
+
+	// Matches stops at the first changed object.
+	auto document = [](std::string_view head)
+	{
+		auto w = Sample::Writer();
+		auto catalog = w.Add("<< /Type /Catalog /Pages 2 0 R >>");
+		w.Add("<< /Type /Pages /Kids [] /Count 0 /Head (" + std::string(head) + ") >>");
+		for (auto i = 0; i < 50; ++i)
+			w.Add("<< /N " + std::to_string(i) + " >>");
+		w.EndSection(catalog);
+		return w.Data();
+	};
+	auto base = Sample::TempFile(document("base"));
+	auto edited = Sample::TempFile(document("edit"));
+	auto doc = Document(edited.Path());
+	CHECK(!doc.Matches(Document(base.Path()).GetFingerprint()));
+	CHECK(doc.GetStatistics().objects < size_t(5));
+}
+
+TEST(compare, containers)
+{
+	auto w = Sample::Writer();
+	auto catalog = w.Add("<< /Type /Catalog /Pages 2 0 R >>");
+	w.Add("<< /Type /Pages /Kids [] /Count 0 >>");
+	w.Add("<< /A 1 /B 2 >>");
+	w.Add("<< /B 2 /A 1 >>");
+	w.Add("<< /A 2 /B 1 >>");
+	w.Add("[1 [2 3] << /K (s) >>]");
+	w.Add("[1 [2 3] << /K (s) >>]");
+	w.Add("[1 [2 4] << /K (s) >>]");
+	w.AddStream("", "0123456789");
+	w.AddStream("", "0123456789");
+	w.AddStream("", "0123456x89");
+	w.EndSection(catalog);
+	auto file = Sample::TempFile(w.Data());
+	auto doc = Document(file.Path());
+	auto object = [&](size_t obj_no) -> const Object & { return doc.GetXref(obj_no).object; };
+
+	// Key order does not matter, swapped values do.
+	CHECK(object(3) == object(4));
+	CHECK_EQ(object(3).Hash(), object(4).Hash());
+	CHECK(object(3) != object(5));
+	CHECK(object(3).Hash() != object(5).Hash());
+
+	CHECK(object(6) == object(7));
+	CHECK(object(6) != object(8));
+
+	// Known hashes of streams only reject; the bytes decide.
+	const auto &stream = doc.GetXref(9).stream;
+	CHECK(stream.Hash() == doc.GetXref(10).stream.Hash());
+	CHECK(stream == doc.GetXref(10).stream);
+	CHECK(stream != doc.GetXref(11).stream);
+}
@@ -0,0 +1,143 @@
+#include "check.h"
+#include "pdf_content.h"
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace PDF;
+
+namespace
+{
+	std::vector<EditRange> diff(const std::vector<hash_t> &l, const std::vector<hash_t> &r, size_t max_cost = 100000)
+	{
+		auto ranges = std::vector<EditRange>();
+		DiffSequences(l.data(), l.size(), r.data(), r.size(), [&](const EditRange &range) { ranges.push_back(range); }, max_cost);
+		return ranges;
+	}
+
+	// Items of both sequences that the edit script leaves untouched must be equal.
+	size_t edit_cost(const std::vector<hash_t> &l, const std::vector<hash_t> &r, const std::vector<EditRange> &ranges)
+	{
+		auto cost = size_t(0);
+		auto li = size_t(0), ri = size_t(0);
+		for (const auto &range : ranges)
+		{
+			for (; li < range.left; ++li, ++ri)
+				CHECK_EQ(l.at(li), r.at(ri));
+			CHECK_EQ(ri, range.right);
+			li += range.left_size;
+			ri += range.right_size;
+			cost += range.left_size + range.right_size;
+		}
+		for (; li < l.size(); ++li, ++ri)
+			CHECK_EQ(l[li], r.at(ri));
+		CHECK_EQ(ri, r.size());
+		return cost;
+	}
+
+	std::string show(const Operation &operation)
+	{
+		auto out = std::ostringstream();
+		out << operation;
+		return out.str();
+	}
+}
+
+TEST(content, lexer)
+{
+	auto lexer = ContentLexer("BT /F1 12 Tf (a\\)b) Tj <41> Tj [1 -2.5] TJ << /K true >> BDC null % note\nET");
+	const ContentLexer::Kind kinds[] = {
+		ContentLexer::Kind::Operator, ContentLexer::Kind::Name, ContentLexer::Kind::Numeric, ContentLexer::Kind::Operator,
+		ContentLexer::Kind::String, ContentLexer::Kind::Operator, ContentLexer::Kind::HexString, ContentLexer::Kind::Operator,
+		ContentLexer::Kind::ArrayBegin, ContentLexer::Kind::Numeric, ContentLexer::Kind::Numeric, ContentLexer::Kind::ArrayEnd, ContentLexer::Kind::Operator,
+		ContentLexer::Kind::DictionaryBegin, ContentLexer::Kind::Name, ContentLexer::Kind::Boolean, ContentLexer::Kind::DictionaryEnd, ContentLexer::Kind::Operator,
+		ContentLexer::Kind::Null, ContentLexer::Kind::Operator, ContentLexer::Kind::End};
+	for (auto kind : kinds)
+		CHECK(lexer.Next().kind == kind);
+	CHECK(lexer.Next().kind == ContentLexer::Kind::End);
+}
+
+TEST(content, inline_image)
+{
+	auto content = std::string("q BI /W 2 /H 1 /BPC 8 /CS /G ID \x00\xff" "EI" "\x01 EI Q", 42);
+	auto operations = Tokenize(content);
+	CHECK_EQ(operations.size(), size_t(5));
+	CHECK_EQ(operations[1].op, std::string_view("BI"));
+	CHECK_EQ(operations[2].op, std::string_view("ID"));
+	CHECK_EQ(show(operations[3]), std::string("[6 bytes] EI"));
+	CHECK_EQ(operations[4].op, std::string_view("Q"));
+}
+
+TEST(content, tokenize)
+{
+	auto l = Tokenize("BT /F1 12 Tf\n72 700 Td (Hello) Tj ET");
+	auto r = Tokenize("BT\n/F1   12 Tf % comment\n72 700 Td\n(Hello) Tj\nET");
+	CHECK_EQ(l.size(), size_t(5));
+	CHECK_EQ(show(l[1]), std::string("/F1 12 Tf"));
+	CHECK_EQ(l.size(), r.size());
+	for (auto i = size_t(0); i < l.size(); ++i)
+		CHECK_EQ(l[i].hash, r[i].hash);
+	CHECK(l[2].hash != Tokenize("72 701 Td")[0].hash);
+}
+
+TEST(content, diff_operations)
+{
+	auto l = Tokenize("q 1 0 0 1 0 0 cm BT (a) Tj ET Q");
+	auto r = Tokenize("q 1 0 0 1 0 0 cm BT (a) Tj (b) Tj ET Q");
+	auto ranges = std::vector<OperationRange>();
+	DiffOperations(l, r, [&](const OperationRange &range) { ranges.push_back(range); });
+	CHECK_EQ(ranges.size(), size_t(1));
+	CHECK_EQ(ranges[0].left, size_t(4));
+	CHECK_EQ(ranges[0].left_size, size_t(0));
+	CHECK_EQ(ranges[0].right_size, size_t(1));
+	CHECK_EQ(show(r[ranges[0].right]), std::string("(b) Tj"));
+}
+
+TEST(sequence, shortest)
+{
+	// The classic example from Myers' paper: ABCABBA to CBABAC takes 5 edits.
+	auto l = std::vector<hash_t>{'A', 'B', 'C', 'A', 'B', 'B', 'A'};
+	auto r = std::vector<hash_t>{'C', 'B', 'A', 'B', 'A', 'C'};
+	CHECK_EQ(edit_cost(l, r, diff(l, r)), size_t(5));
+
+	CHECK(diff(l, l).empty());
+	CHECK_EQ(edit_cost({}, r, diff({}, r)), r.size());
+	CHECK_EQ(edit_cost(l, {}, diff(l, {})), l.size());
+}
+
+TEST(sequence, random)
+{
+	auto state = uint32_t(1);
+	auto next = [&] { return state = state * 1103515245 + 12345; };
+	for (auto round = 0; round < 50; ++round)
+	{
+		auto l = std::vector<hash_t>();
+		for (auto i = next() % 300; i > 0; --i)
+			l.push_back(next() >> 28);
+		auto r = l;
+		auto edits = size_t(next() % 20);
+		for (auto i = size_t(0); i < edits && !r.empty(); ++i)
+		{
+			auto at = next() % r.size();
+			if (next() & 1)
+				r.erase(r.begin() + at);
+			else
+				r.insert(r.begin() + at, next() >> 28);
+		}
+		// Never worse than the edits that made r.
+		CHECK(edit_cost(l, r, diff(l, r)) <= edits);
+	}
+}
+
+TEST(sequence, max_cost)
+{
+	auto l = std::vector<hash_t>(1000);
+	auto r = std::vector<hash_t>(1000);
+	for (auto i = size_t(0); i < l.size(); ++i)
+	{
+		l[i] = 2 * i;
+		r[i] = 2 * i + 1;
+	}
+	// Over the cost limit the result is still a valid script.
+	edit_cost(l, r, diff(l, r, 10));
+}
@@ -0,0 +1,203 @@
+#include "check.h"
+#include "pdf.h"
+#include "pdf_filter.h"
+#include "sample.h"
+
+using namespace PDF;
+
+namespace
+{
+	/**
+	 * Streams 1..n with the given dictionary entries and raw data.
+	 */
+	class Streams
+	{
+	public:
+		explicit Streams(const std::vector<std::pair<std::string, std::string>> &streams)
+		{
+			auto w = Sample::Writer();
+			auto catalog = w.Reserve();
+			auto pages = w.Add("<< /Type /Pages /Kids [] /Count 0 >>");
+			for (const auto &stream : streams)
+				m_Numbers.push_back(w.AddStream(stream.first, stream.second));
+			w.Add("<< /Type /Catalog /Pages " + std::to_string(pages) + " 0 R >>", catalog);
+			w.EndSection(catalog);
+			m_File = std::make_unique<Sample::TempFile>(w.Data());
+			m_Document = std::make_unique<Document>(m_File->Path());
+		}
+
+		const Xref &operator[](size_t index) const { return m_Document->GetXref(m_Numbers.at(index)); }
+
+		std::string Decoded(size_t index, bool partial = false, const resolver_t &resolve = nullptr) const
+		{
+			const auto &xref = (*this)[index];
+			auto data = Decode(xref.object, xref.stream, partial, resolve);
+			return std::string(data.begin(), data.end());
+		}
+
+	private:
+		std::unique_ptr<Sample::TempFile> m_File;
+		std::unique_ptr<Document> m_Document;
+		std::vector<size_t> m_Numbers;
+	};
+
+	std::string hex(std::string_view data)
+	{
+		const char digits[] = "0123456789ABCDEF";
+		auto out = std::string();
+		for (auto c : data)
+		{
+			out += digits[(static_cast<unsigned char>(c) >> 4)];
+			out += digits[c & 0xf];
+		}
+		return out + ">";
+	}
+}
+
+TEST(filter, ascii)
+{
+	auto streams = Streams({
+		{"/Filter /ASCIIHexDecode", "48 65 6c 6C\n6f>"},
+		{"/Filter /AHx", "48656C6C6>"}, // odd digit count: the last one is followed by 0
+		{"/Filter /ASCII85Decode", "87cURD_*#TDfTZ)+TMKB!+g%Y~>"},
+		{"/Filter /A85", "z~>"},
+	});
+	CHECK_EQ(streams.Decoded(0), std::string("Hello"));
+	CHECK_EQ(streams.Decoded(1), std::string("Hell`"));
+	CHECK_EQ(streams.Decoded(2), std::string("Hello, world!\0\0\0\0end", 20));
+	CHECK_EQ(streams.Decoded(3), std::string(4, '\0'));
+}
+
+TEST(filter, run_length)
+{
+	auto streams = Streams({{"/Filter /RunLengthDecode", std::string("\x02" "abc" "\xfe" "x" "\x80", 7)}});
+	CHECK_EQ(streams.Decoded(0), std::string("abcxxx"));
+}
+
+TEST(filter, flate)
+{
+	auto text = std::string();
+	for (auto i = 0; i < 10000; ++i)
+		text += "line " + std::to_string(i) + "\n";
+	auto streams = Streams({{"/Filter /FlateDecode", Sample::Flate(text)}, {"/Filter /Fl", Sample::Flate("")}});
+	CHECK_EQ(streams.Decoded(0), text);
+	CHECK_EQ(streams.Decoded(1), std::string());
+}
+
+TEST(filter, predictors)
+{
+	// PNG rows of 3 bytes, each prefixed by its filter type: Up, Up, Sub.
+	auto png = std::string("\x02\x01\x02\x03" "\x02\x01\x01\x01" "\x01\x05\x01\x01", 12);
+	auto tiff = std::string("\x01\x01\x01\x05\x00\xff", 6);
+	auto streams = Streams({
+		{"/Filter /FlateDecode /DecodeParms << /Predictor 12 /Columns 3 >>", Sample::Flate(png)},
+		{"/Filter /FlateDecode /DecodeParms << /Predictor 2 /Columns 3 >>", Sample::Flate(tiff)},
+	});
+	CHECK_EQ(streams.Decoded(0), std::string("\x01\x02\x03\x02\x03\x04\x05\x06\x07", 9));
+	CHECK_EQ(streams.Decoded(1), std::string("\x01\x02\x03\x05\x05\x04", 6));
+}
+
+TEST(filter, chain)
+{
+	auto streams = Streams({
+		{"/Filter [/AHx /Fl]", hex(Sample::Flate("chained"))},
+		{"/Filter [/ASCIIHexDecode /FlateDecode] /DecodeParms [null << /Predictor 12 /Columns 2 >>]", hex(Sample::Flate(std::string("\x00\x61\x62\x02\x01\x01", 6)))},
+	});
+	CHECK_EQ(streams.Decoded(0), std::string("chained"));
+	CHECK_EQ(streams.Decoded(1), std::string("abbc"));
+}
+
+TEST(filter, unsupported)
+{
+	auto streams = Streams({{"/Filter [/AHx /DCTDecode]", "FFD8FF>"}, {"/Filter /ASCII85Decode", "ab{~>"}});
+	CHECK_THROWS(streams.Decoded(0), parse_error);
+	CHECK_EQ(streams.Decoded(0, true), std::string("\xff\xd8\xff"));
+	CHECK_THROWS(streams.Decoded(1), parse_error);
+}
+
+TEST(filter, compare_decoded)
+{
+	auto text = std::string(50000, 'a') + "b";
+	auto other = std::string(50000, 'a') + "c";
+	auto streams = Streams({
+		{"/Filter /FlateDecode", Sample::Flate(text)},
+		{"/Filter [/AHx /Fl]", hex(Sample::Flate(text))},
+		{"/Filter /FlateDecode", Sample::Flate(other)},
+	});
+	auto open = [&](size_t index) { return OpenDecoder(streams[index].object, streams[index].stream); };
+
+	CHECK(CompareDecoded(*open(0), *open(1)).Equal());
+	auto mismatch = CompareDecoded(*open(0), *open(2), true);
+	CHECK_EQ(mismatch.first, size_t(50000));
+	CHECK_EQ(mismatch.left_size, text.size());
+	CHECK_EQ(mismatch.right_size, other.size());
+}
+
+TEST(filter, indirect)
+{
+	auto streams = Streams({
+		{"/Filter 1 0 R", Sample::Flate("indirect")},
+		{"/Filter [1 0 R] /DecodeParms 2 0 R", Sample::Flate(std::string("\x02\x01\x02\x03" "\x02\x01\x01\x01", 8))},
+		{"/Filter [/AHx 1 0 R] /DecodeParms [null << /Predictor 3 0 R /Columns 3 >>]", hex(Sample::Flate(std::string("\x00" "abc", 4)))},
+	});
+
+	// The resolver stands in for a document: 1 is the filter, 2 the
+	// parameters and 3 a number.
+	auto arena = Arena();
+	auto scope = Arena::Scope(arena);
+	auto parms = Dictionary();
+	parms[Name::Predictor] = Object(12.0);
+	parms[Name::Columns] = Object(3.0);
+	const Object objects[] = {Object(), Object(name_t(Name::FlateDecode)), Object(std::move(parms)), Object(10.0)};
+	auto resolve = resolver_t([&](const Object &obj) { return objects[obj.GetIndirect()]; });
+
+	CHECK_EQ(streams.Decoded(0, false, resolve), std::string("indirect"));
+	CHECK_EQ(streams.Decoded(1, false, resolve), std::string("\x01\x02\x03\x02\x03\x04", 6));
+	CHECK_EQ(streams.Decoded(2, false, resolve), std::string("abc"));
+
+	// Without a resolver the references are type errors, also with `partial`.
+	CHECK_THROWS(streams.Decoded(0), type_error);
+	CHECK_THROWS(streams.Decoded(1, true), type_error);
+	CHECK_THROWS(streams.Decoded(2), type_error);
+}
+
+TEST(filter, not_a_name)
+{
+	auto streams = Streams({{"/Filter [/AHx 12]", "41>"}, {"/Filter (FlateDecode)", ""}, {"/Filter /Fl /DecodeParms << /Predictor (12) >>", Sample::Flate("x")}});
+	CHECK_THROWS(streams.Decoded(0), type_error);
+	CHECK_THROWS(streams.Decoded(1, true), type_error);
+	CHECK_THROWS(streams.Decoded(2), type_error);
+}
+
+TEST(filter, indirect_documents)
+{
+	// Object 3 is the filter, referred to by the stream of the first file.
+	auto file = [](std::string_view filter, std::string_view data) {
+		auto w = Sample::Writer();
+		auto catalog = w.Add("<< /Type /Catalog /Pages 2 0 R >>");
+		w.Add("<< /Type /Pages /Kids [] /Count 0 >>");
+		w.Add("/FlateDecode");
+		w.AddStream(filter, data);
+		w.EndSection(catalog);
+		return std::make_unique<Sample::TempFile>(w.Data());
+	};
+	auto indirect = file("/Filter 3 0 R", Sample::Flate("the same content"));
+	auto direct = file("/Filter /AHx", hex("the same content"));
+	auto other = file("/Filter 3 0 R", Sample::Flate("some other text"));
+
+	auto options = Options();
+	options.decoded = true;
+	auto l = Document(indirect->Path(), options);
+	auto r = Document(direct->Path(), options);
+	CHECK(l == r);
+	CHECK(l.GetFingerprint() == r.GetFingerprint());
+	auto report = DiffReport();
+	l.diff(report, r);
+	CHECK_EQ(report.size(), size_t(0));
+
+	auto o = Document(other->Path(), options);
+	CHECK(!(l == o));
+	CHECK(!(l.GetFingerprint() == o.GetFingerprint()));
+	l.diff(report, o);
+	CHECK(report.size() > 0);
+}
@@ -0,0 +1,145 @@
+#include "check.h"
+#include "pdf.h"
+#include "sample.h"
+
+using namespace PDF;
+
+namespace
+{
+	/**
+	 * A one page document whose object 4 is `body`.
+	 */
+	std::string with_object(std::string_view body)
+	{
+		auto w = Sample::Writer();
+		auto catalog = w.Add("<< /Type /Catalog /Pages 2 0 R >>");
+		w.Add("<< /Type /Pages /Kids [3 0 R] /Count 1 >>");
+		w.Add("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792] >>");
+		w.Add(body);
+		w.EndSection(catalog);
+		return w.Data();
+	}
+
+	void replace_all(std::string &data, std::string_view from, std::string_view to)
+	{
+		for (auto at = data.find(from); at != std::string::npos; at = data.find(from, at + to.size()))
+			data.replace(at, from.size(), to);
+	}
+}
+
+TEST(lexer, scalars)
+{
+	auto file = Sample::TempFile(with_object("[true false null 42 -3.5 .25 +7 /Name /A;B (a (nested) \\) string) <41 42> % comment\n 9]"));
+	auto doc = Document(file.Path());
+	const auto &array = doc.GetXref(4).object.GetArray();
+	CHECK_EQ(array.size(), size_t(12));
+	CHECK(array[0] == Object::Type::BOOLEAN && array[0].GetBoolean());
+	CHECK(array[1] == Object::Type::BOOLEAN && !array[1].GetBoolean());
+	CHECK(array[2] == Object::Type::NIL);
+	CHECK_EQ(array[3].GetNumeric(), 42.0);
+	CHECK_EQ(array[4].GetNumeric(), -3.5);
+	CHECK_EQ(array[5].GetNumeric(), 0.25);
+	CHECK_EQ(array[6].GetNumeric(), 7.0);
+	CHECK(array[7] == "Name");
+	CHECK(array[8] == "A;B");
+	CHECK_EQ(array[9].GetString(), std::string_view("(a (nested) \\) string)"));
+	CHECK_EQ(array[10].GetString(), std::string_view("<41 42>"));
+	CHECK_EQ(array[11].GetNumeric(), 9.0);
+}
+
+TEST(lexer, references)
+{
+	auto file = Sample::TempFile(with_object("<< /Ref 3 0 R /Gen 7 12 R /Pair [1 2] /Tail [5 0] /Last 6 0 R>>"));
+	auto doc = Document(file.Path());
+	const auto &dic = doc.GetXref(4).object;
+	CHECK(dic[Name("Ref")] == Object::Type::INDIRECT);
+	CHECK_EQ(dic[Name("Ref")].GetIndirect(), indirect_t(3));
+	CHECK_EQ(dic[Name("Gen")].GetIndirect(), indirect_t(7));
+	CHECK_EQ(dic[Name("Gen")].GetGeneration(), uint16_t(12));
+
+	// Two numbers not followed by R stay numbers.
+	const auto &pair = dic[Name("Pair")].GetArray();
+	CHECK_EQ(pair.size(), size_t(2));
+	CHECK(pair[0] == Object::Type::NUMERIC && pair[1] == Object::Type::NUMERIC);
+	CHECK_EQ(dic[Name("Tail")].GetArray().size(), size_t(2));
+
+	// R directly followed by a delimiter.
+	CHECK_EQ(dic[Name("Last")].GetIndirect(), indirect_t(6));
+}
+
+TEST(lexer, display)
+{
+	auto file = Sample::TempFile(with_object("<< /Type /Annot /Rect [1 2 3 4] /P 3 0 R /Inner << /A true >> >>"));
+	auto doc = Document(file.Path());
+	CHECK_EQ(doc.GetXref(4).object.Display(), std::string("<</Inner <</A 1 >> /P 3 0 R /Rect [1 2 3 4 ] /Type /Annot >>"));
+}
+
+TEST(lexer, nested_dictionaries)
+{
+	auto file = Sample::TempFile(with_object("<</A<</B<</C[<</D 1>>]>>>>>>"));
+	auto doc = Document(file.Path());
+	const auto &d = doc.GetXref(4).object[Name("A")][Name("B")][Name("C")].GetArray()[0][Name("D")];
+	CHECK_EQ(d.GetNumeric(), 1.0);
+}
+
+TEST(xref_rows, table)
+{
+	auto file = Sample::TempFile(Sample::Pages(3));
+	auto doc = Document(file.Path());
+	CHECK_EQ(doc.GetRevisionCount(), size_t(1));
+	const auto &entries = doc.GetRevision(0).entries;
+	CHECK_EQ(entries.size(), doc.GetXrefSize());
+	CHECK(!entries[0].used);
+	CHECK_EQ(entries[0].revision, 65535);
+	for (auto i = size_t(1); i < entries.size(); ++i)
+	{
+		CHECK(entries[i].used);
+		CHECK_EQ(entries[i].obj_no, indirect_t(i));
+	}
+	CHECK_EQ(doc.GetPageCount(), size_t(3));
+}
+
+TEST(xref_rows, line_ends)
+{
+	// 3.4.3: the two-character end of line may be SP CR, SP LF or CR LF.
+	for (auto eol : {" \r", "\r\n"})
+	{
+		auto data = Sample::Pages(2);
+		replace_all(data, " n \n", std::string(" n") + eol);
+		replace_all(data, " f \n", std::string(" f") + eol);
+		auto file = Sample::TempFile(data);
+		auto doc = Document(file.Path());
+		CHECK_EQ(doc.GetPageCount(), size_t(2));
+		CHECK(doc.GetXref(1).object == Object::Type::DICTIONARY);
+	}
+}
+
+TEST(xref_rows, free_entries)
+{
+	auto data = with_object("(unused)");
+	auto row = data.find(" 00000 n \n", data.find("xref"));
+	for (auto i = 0; i < 3; ++i)
+		row = data.find(" 00000 n \n", row + 1);
+	data.replace(row, 10, " 00002 f \n");
+
+	auto file = Sample::TempFile(data);
+	auto doc = Document(file.Path());
+	const auto &entry = doc.GetRevision(0).entries.at(4);
+	CHECK(!entry.used);
+	CHECK_EQ(entry.revision, 2);
+	CHECK(!doc.GetXref(4).used);
+}
+
+TEST(xref_rows, malformed)
+{
+	auto data = Sample::Pages(2);
+	auto row = data.find(" 00000 n \n", data.find("xref"));
+	data[row - 3] = 'x';
+	auto file = Sample::TempFile(data);
+	CHECK_THROWS(Document(file.Path()), std::logic_error);
+
+	auto truncated = Sample::Pages(2);
+	truncated.resize(truncated.rfind("%%EOF"));
+	auto cut = Sample::TempFile(truncated);
+	CHECK_THROWS(Document(cut.Path()), std::logic_error);
+}
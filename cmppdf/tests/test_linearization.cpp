@@ -0,0 +1,76 @@
+#include "check.h"
+#include "pdf.h"
+#include "sample.h"
+
+using namespace PDF;
+
+namespace
+{
+	// Object numbers Sample::Linearized gives its pages.
+	indirect_t page_no(size_t pages, size_t index) { return indirect_t(index ? 1 + 2 * (index - 1) : 2 * (pages - 1) + 2 + 7); }
+}
+
+TEST(linearization, parameters)
+{
+	auto data = Sample::Linearized(20);
+	auto file = Sample::TempFile(data);
+	auto doc = Document(file.Path());
+	const auto *linearization = doc.GetLinearization();
+	CHECK(linearization != nullptr);
+	CHECK_EQ(linearization->length, data.size());
+	CHECK_EQ(linearization->pages, size_t(20));
+	CHECK_EQ(linearization->first_page, page_no(20, 0));
+	CHECK(linearization->hint_offset > 0 && linearization->hint_length > 0);
+	CHECK(linearization->main_xref < data.size());
+}
+
+TEST(linearization, page_offsets)
+{
+	auto file = Sample::TempFile(Sample::Linearized(20));
+	auto doc = Document(file.Path());
+	const auto &offsets = doc.GetLinearization()->page_offsets;
+	CHECK_EQ(offsets.size(), size_t(20));
+	for (auto i = size_t(0); i < offsets.size(); ++i)
+		CHECK_EQ(size_t(doc.GetXref(page_no(20, i)).offset), offsets[i]);
+}
+
+TEST(linearization, locate_page)
+{
+	auto file = Sample::TempFile(Sample::Linearized(20));
+	auto doc = Document(file.Path());
+	for (auto i = size_t(0); i < 20; ++i)
+		CHECK_EQ(doc.LocatePage(i), page_no(20, i));
+	CHECK_EQ(doc.LocatePage(20), indirect_t(0));
+	CHECK_EQ(doc.GetPageCount(), size_t(20));
+}
+
+TEST(linearization, broken_hints)
+{
+	// The hint table is dropped, and pages are found through the page tree.
+	auto file = Sample::TempFile(Sample::Linearized(20, true));
+	auto doc = Document(file.Path());
+	CHECK(doc.GetLinearization() != nullptr);
+	CHECK(doc.GetLinearization()->page_offsets.empty());
+	for (auto i = size_t(0); i < 20; ++i)
+		CHECK_EQ(doc.LocatePage(i), page_no(20, i));
+}
+
+TEST(linearization, single_page)
+{
+	auto file = Sample::TempFile(Sample::Linearized(1));
+	auto doc = Document(file.Path());
+	CHECK_EQ(doc.GetLinearization()->page_offsets.size(), size_t(1));
+	CHECK_EQ(doc.LocatePage(0), page_no(1, 0));
+}
+
+TEST(linearization, not_linearized)
+{
+	auto plain = Sample::TempFile(Sample::Pages(3));
+	CHECK(Document(plain.Path()).GetLinearization() == nullptr);
+
+	// A changed size makes /L wrong, so the parameters no longer hold.
+	auto data = Sample::Linearized(3);
+	data.insert(data.rfind("startxref"), "% changed\n");
+	auto updated = Sample::TempFile(data);
+	CHECK(Document(updated.Path()).GetLinearization() == nullptr);
+}
@@ -0,0 +1,54 @@
+#include "check.h"
+#include "pdf.h"
+#include "sample.h"
+
+using namespace PDF;
+
+TEST(name, known)
+{
+	CHECK(Name("MediaBox") == Name::MediaBox);
+	CHECK_EQ(Name(Name::ObjStm).View(), std::string_view("ObjStm"));
+	auto found = Name();
+	CHECK(Name::Find("Type", found));
+	CHECK(found == Name::Type);
+	CHECK(!Name::Find("NeverSeenBeforeName", found));
+}
+
+TEST(name, append_only)
+{
+	// Views stay valid while the table grows past several text blocks.
+	auto first = Name("FirstOfMany");
+	auto view = first.View();
+	auto count = Name::GetCount();
+	for (auto i = 0; i < 20000; ++i)
+		Name("Many" + std::to_string(i));
+	CHECK_EQ(Name::GetCount(), count + 20000);
+	CHECK_EQ(view.data(), first.View().data());
+	CHECK_EQ(Name("Many123").View(), std::string_view("Many123"));
+	CHECK(Name::GetCount() < Name::GetLimit());
+
+	// Longer than a text block.
+	auto long_text = std::string(100000, 'n');
+	CHECK_EQ(Name(long_text).View(), std::string_view(long_text));
+	CHECK_EQ(Name("AfterLong").View(), std::string_view("AfterLong"));
+}
+
+TEST(name, document)
+{
+	// Names read from a document outlive it.
+	auto name = Name();
+	{
+		auto w = Sample::Writer();
+		auto catalog = w.Add("<< /Type /Catalog /Pages 2 0 R /OnlyInThisFile 1 >>");
+		w.Add("<< /Type /Pages /Kids [] /Count 0 >>");
+		w.EndSection(catalog);
+		auto file = Sample::TempFile(w.Data());
+		auto doc = Document(file.Path());
+		for (const auto &item : doc.GetXref(1).object.GetDictionary())
+			if (item.first.View() == "OnlyInThisFile")
+				name = item.first;
+	}
+	CHECK_EQ(name.View(), std::string_view("OnlyInThisFile"));
+	auto found = Name();
+	CHECK(Name::Find("OnlyInThisFile", found) && found == name);
+}
@@ -0,0 +1,82 @@
+#include "check.h"
+#include "pdf.h"
+#include "pdf_printer.h"
+#include "sample.h"
+
+using namespace PDF;
+
+namespace
+{
+	/**
+	 * A one page document whose object 4 is `body`.
+	 */
+	std::string with_object(std::string_view body)
+	{
+		auto w = Sample::Writer();
+		auto catalog = w.Add("<< /Type /Catalog /Pages 2 0 R >>");
+		w.Add("<< /Type /Pages /Kids [3 0 R] /Count 1 >>");
+		w.Add("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792] >>");
+		w.Add(body);
+		w.EndSection(catalog);
+		return w.Data();
+	}
+
+	std::string print(std::string_view body, const PrintLimits &limits = PrintLimits())
+	{
+		auto file = Sample::TempFile(with_object(body));
+		auto doc = Document(file.Path());
+		auto text = std::string();
+		Printer(text, limits).Print(doc.GetXref(4).object);
+		return text;
+	}
+}
+
+TEST(printer, objects)
+{
+	CHECK_EQ(print("<< /Type /Annot /Rect [1 2 3 4] /P 3 0 R /T (title) >>"), std::string("<</P 3 0 R /Rect [1 2 3 4 ] /T (title) /Type /Annot >>"));
+	CHECK_EQ(print("[null true 0.5 /N]"), std::string("[null 1 0.5 /N ]"));
+}
+
+TEST(printer, long_array)
+{
+	// [..n..] counts the entries of an array longer than array_bytes.
+	auto body = std::string("[");
+	for (auto i = 0; i < 40; ++i)
+		body += "100 ";
+	body += "]";
+	CHECK_EQ(print(body), std::string("[..40..]"));
+	CHECK_EQ(print("<< /Kids " + body + " >>"), std::string("<</Kids [..40..] >>"));
+
+	// Up to array_bytes the entries are written.
+	CHECK_EQ(print("[1 2 3 4 5 6 7 8 9 10 11 12 13]"), std::string("[1 2 3 4 5 6 7 8 9 10 11 12 13 ]"));
+	CHECK_EQ(print("[1 2 3 4 5 6 7 8 9 10 11 12 13 14]"), std::string("[..14..]"));
+}
+
+TEST(printer, nested_in_large_dictionary)
+{
+	// The nested dictionaries are printed while the outer one is still
+	// being walked, past the point where its entries are cut off.
+	auto body = std::string("<< /A << /B << /C 1 >> >>");
+	for (auto i = 0; i < 299; ++i)
+		body += " /K" + std::to_string(1000 + i) + " " + std::to_string(i);
+	body += " >>";
+	auto text = print(body);
+	CHECK_EQ(text.substr(0, 31), std::string("<</A <</B <</C 1 >> >> /K1000 0"));
+	CHECK_EQ(text.substr(text.size() - 14), std::string("..44 more.. >>"));
+}
+
+TEST(printer, limits)
+{
+	auto limits = PrintLimits();
+	limits.elements = 2;
+	CHECK_EQ(print("[1 2 3 4 5]", limits), std::string("[1 2 ..3 more.. ]"));
+	CHECK_EQ(print("<< /A 1 /B 2 /C 3 >>", limits), std::string("<</A 1 /B 2 ..1 more.. >>"));
+
+	limits = PrintLimits();
+	limits.depth = 2;
+	CHECK_EQ(print("[[[1]] << /A << /B 1 >> >>]", limits), std::string("[[[...] ] <</A <<...>> >> ]"));
+
+	limits = PrintLimits();
+	limits.bytes = 10;
+	CHECK_EQ(print("<< /Alpha 1 /Beta 2 /Gamma 3 >>", limits), std::string("<</Alpha 1..."));
+}
@@ -0,0 +1,109 @@
+#include "check.h"
+#include "pdf_report.h"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+using namespace PDF;
+
+namespace
+{
+	DiffReport sample()
+	{
+		auto report = DiffReport();
+		report.Add(DiffRecord::Kind::Section, 0, "Xref table [5]");
+		report.Add(DiffRecord::Kind::Group, 1, "Object");
+		report.Changed(2, "Count", 3, 4);
+		report.Add(DiffRecord::Kind::Note, 2, "Kids", "different size");
+		report.Add(DiffRecord::Kind::Offset, 1, "Stream", "17");
+		report.Add(DiffRecord::Kind::Range, 1, "Range", "4, 8", "4, 9");
+		report.Add(DiffRecord::Kind::Removed, 1, "", "1 0 0 1 0 0 cm");
+		report.Add(DiffRecord::Kind::Inserted, 1, "", "", std::string_view("(\"\\\x01)", 5));
+		return report;
+	}
+
+	std::string render(std::string_view format, const DiffReport &report)
+	{
+		auto out = std::ostringstream();
+		auto writer = ReportWriter::Create(format, out);
+		CHECK(writer != nullptr);
+		writer->Write(report);
+		return out.str();
+	}
+}
+
+TEST(report, records)
+{
+	auto report = sample();
+	CHECK_EQ(report.size(), size_t(8));
+	auto record = report[2];
+	CHECK(record.kind == DiffRecord::Kind::Changed);
+	CHECK_EQ(record.depth, size_t(2));
+	CHECK_EQ(record.label, std::string_view("Count"));
+	CHECK_EQ(record.left, std::string_view("3"));
+	CHECK_EQ(record.right, std::string_view("4"));
+
+	auto outer = DiffReport();
+	outer.Add(DiffRecord::Kind::Section, 0, "Page 1");
+	outer.Append(report, 1);
+	CHECK_EQ(outer.size(), size_t(9));
+	CHECK_EQ(outer[3].depth, size_t(3));
+	CHECK_EQ(outer[3].left, std::string_view("3"));
+}
+
+TEST(report, text)
+{
+	CHECK_EQ(render("text", sample()),
+			 std::string("Xref table [5]\n"
+						 "    Object:\n"
+						 "        Count: 3 / 4\n"
+						 "        Kids: different size\n"
+						 "    Stream[17]\n"
+						 "    Range[4, 8) / [4, 9)\n"
+						 "    < 1 0 0 1 0 0 cm\n"
+						 "    > (\"\\\x01)\n"));
+}
+
+TEST(report, ndjson)
+{
+	CHECK_EQ(render("ndjson", sample()),
+			 std::string("{\"path\":[\"Xref table [5]\"],\"kind\":\"section\"}\n"
+						 "{\"path\":[\"Xref table [5]\",\"Object\"],\"kind\":\"group\"}\n"
+						 "{\"path\":[\"Xref table [5]\",\"Object\",\"Count\"],\"kind\":\"changed\",\"left\":\"3\",\"right\":\"4\"}\n"
+						 "{\"path\":[\"Xref table [5]\",\"Object\",\"Kids\"],\"kind\":\"note\",\"message\":\"different size\"}\n"
+						 "{\"path\":[\"Xref table [5]\",\"Stream\"],\"kind\":\"offset\",\"left\":\"17\"}\n"
+						 "{\"path\":[\"Xref table [5]\",\"Range\"],\"kind\":\"range\",\"left\":\"4, 8\",\"right\":\"4, 9\"}\n"
+						 "{\"path\":[\"Xref table [5]\"],\"kind\":\"removed\",\"left\":\"1 0 0 1 0 0 cm\"}\n"
+						 "{\"path\":[\"Xref table [5]\"],\"kind\":\"inserted\",\"right\":\"(\\\"\\\\\\u0001)\"}\n"));
+}
+
+TEST(report, binary)
+{
+	auto report = DiffReport();
+	report.Add(DiffRecord::Kind::Section, 0, "S");
+	report.Add(DiffRecord::Kind::Changed, 200, "ab", "1", std::string(130, 'x'));
+	auto expected = std::string("CMPPDFDR\x01", 9);
+	expected += std::string("\x00\x00\x01S\x00\x00", 6);
+	expected += std::string("\x02\xc8\x01\x02" "ab" "\x01" "1" "\x82\x01", 10) + std::string(130, 'x');
+	CHECK_EQ(render("binary", report), expected);
+}
+
+TEST(report, empty)
+{
+	// A binary report is recognizable even when it holds no record.
+	CHECK_EQ(render("binary", DiffReport()), std::string("CMPPDFDR\x01", 9));
+	CHECK_EQ(render("text", DiffReport()), std::string());
+	CHECK_EQ(render("ndjson", DiffReport()), std::string());
+}
+
+TEST(report, large)
+{
+	// Far more than one output block.
+	auto report = DiffReport();
+	for (auto i = 0; i < 20000; ++i)
+		report.Changed(1, "Entry " + std::to_string(i), i, i + 1);
+	auto text = render("text", report);
+	CHECK_EQ(size_t(std::count(text.begin(), text.end(), '\n')), size_t(20000));
+	CHECK_EQ(text.substr(text.rfind('\n', text.size() - 2) + 1), std::string("    Entry 19999: 19999 / 20000\n"));
+	CHECK(ReportWriter::Create("xml", std::cout) == nullptr);
+}
@@ -0,0 +1,102 @@
+#include "check.h"
+#include "pdf.h"
+#include "sample.h"
+#include <sstream>
+
+using namespace PDF;
+
+namespace
+{
+	std::string revisions(const Document &doc, size_t count)
+	{
+		auto report = DiffReport();
+		doc.DiffRevisions(report, count);
+		auto out = std::ostringstream();
+		ReportWriter::Create("text", out)->Write(report);
+		return out.str();
+	}
+
+	/**
+	 * Three sections: the original, one changing the page size and adding
+	 * an object, one changing the title.
+	 */
+	std::string updated(Sample::Writer::Xref format)
+	{
+		auto w = Sample::Writer("1.5");
+		auto catalog = w.Add("<< /Type /Catalog /Pages 2 0 R >>");
+		w.Add("<< /Type /Pages /Kids [3 0 R] /Count 1 >>");
+		w.Add("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792] >>");
+		w.Add("<< /Title (first) >>");
+		w.EndSection(catalog, format, "/Info 4 0 R");
+		w.Add("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 595 842] >>", 3);
+		w.Add("(added)", 6);
+		w.EndSection(catalog, format, "/Info 4 0 R");
+		w.Add("<< /Title (second) >>", 4);
+		w.EndSection(catalog, format, "/Info 4 0 R");
+		return w.Data();
+	}
+}
+
+TEST(revisions, chain)
+{
+	for (auto format : {Sample::Writer::Xref::Table, Sample::Writer::Xref::Stream})
+	{
+		auto file = Sample::TempFile(updated(format));
+		auto doc = Document(file.Path());
+		CHECK_EQ(doc.GetRevisionCount(), size_t(3));
+		CHECK(doc.GetRevision(0).offset < doc.GetRevision(1).offset);
+		CHECK(doc.GetRevision(1).offset < doc.GetRevision(2).offset);
+		CHECK_EQ(doc.GetXref(4).object[Name("Title")].GetString(), std::string_view("(second)"));
+		CHECK_EQ(doc.GetXref(3).object[Name::MediaBox].GetArray()[2].GetNumeric(), 595.0);
+		CHECK_EQ(doc.GetXref(4).revision, 0);
+	}
+}
+
+TEST(revisions, diff_last)
+{
+	auto file = Sample::TempFile(updated(Sample::Writer::Xref::Table));
+	auto doc = Document(file.Path());
+	auto text = revisions(doc, 1);
+	CHECK(text.find("Revisions: 3\n") == 0);
+	CHECK(text.find("Revision [2]") != std::string::npos);
+	CHECK(text.find("Revision [1]") == std::string::npos);
+	CHECK(text.find("Xref table [4]") != std::string::npos);
+	CHECK(text.find("(first) / (second)") != std::string::npos);
+	CHECK(text.find("Xref table [3]") == std::string::npos);
+}
+
+TEST(revisions, diff_two)
+{
+	auto file = Sample::TempFile(updated(Sample::Writer::Xref::Stream));
+	auto doc = Document(file.Path());
+	auto text = revisions(doc, 2);
+	CHECK(text.find("Revision [1]") != std::string::npos);
+	CHECK(text.find("Xref table [3]") != std::string::npos);
+	CHECK(text.find("Xref table [4]") != std::string::npos);
+	CHECK(text.find("Xref table [6]: No entry before revision [1].") != std::string::npos);
+
+	// Nothing is older than every revision.
+	auto all = revisions(doc, 10);
+	CHECK(all.find("Xref table [1]: No entry before revision [0].") != std::string::npos);
+}
+
+TEST(revisions, redefined_container)
+{
+	// Object 4 was compressed in object stream 5, which the update reuses
+	// for another object; the old title is still read from the old stream.
+	auto w = Sample::Writer("1.5");
+	auto catalog = w.Add("<< /Type /Catalog /Pages 2 0 R >>");
+	w.Add("<< /Type /Pages /Kids [] /Count 0 >>");
+	w.AddObjectStream({{4, "<< /Title (first) >>"}}, 5);
+	w.EndSection(catalog, Sample::Writer::Xref::Stream, "/Info 4 0 R");
+	w.Add("<< /Title (second) >>", 4);
+	w.AddObjectStream({{8, "<< /Title (other) >>"}}, 5);
+	w.EndSection(catalog, Sample::Writer::Xref::Stream, "/Info 4 0 R");
+
+	auto file = Sample::TempFile(w.Data());
+	auto doc = Document(file.Path());
+	auto text = revisions(doc, 1);
+	CHECK(text.find("(first) / (second)") != std::string::npos);
+	CHECK(text.find("(other)") == std::string::npos);
+	CHECK(text.find("Xref table [8]: No entry before revision [1].") != std::string::npos);
+}
@@ -0,0 +1,123 @@
+#include "check.h"
+#include "pdf.h"
+#include "sample.h"
+#include <algorithm>
+
+using namespace PDF;
+
+namespace
+{
+	/**
+	 * "depth label" of every note of the traversal.
+	 */
+	std::vector<std::string> notes(const Document &doc)
+	{
+		auto report = DiffReport();
+		doc.Traverse(report);
+		auto lines = std::vector<std::string>();
+		for (auto i = size_t(0); i < report.size(); ++i)
+		{
+			auto record = report[i];
+			CHECK(record.kind == DiffRecord::Kind::Note);
+			lines.push_back(std::to_string(record.depth) + " " + std::string(record.label));
+		}
+		return lines;
+	}
+}
+
+TEST(structure, pages)
+{
+	for (auto format : {Sample::Writer::Xref::Table, Sample::Writer::Xref::Stream})
+	{
+		auto file = Sample::TempFile(Sample::Pages(2, format));
+		auto doc = Document(file.Path());
+		auto lines = notes(doc);
+		CHECK(lines.size() >= 5);
+		CHECK_EQ(lines[0], std::string("0 Catalog"));
+		CHECK_EQ(lines[1], std::string("1 Pages"));
+		CHECK_EQ(lines[2], std::string("2 Page [0]"));
+		CHECK_EQ(lines.back(), std::string("3 Contents"));
+		CHECK(std::find(lines.begin(), lines.end(), "2 Page [1]") != lines.end());
+	}
+}
+
+TEST(structure, contents)
+{
+	auto file = Sample::TempFile(Sample::Pages(1));
+	auto doc = Document(file.Path());
+	auto report = DiffReport();
+	doc.Traverse(report);
+	auto last = report[report.size() - 1];
+	CHECK_EQ(last.label, std::string_view("Contents"));
+	CHECK_EQ(last.left, std::string_view("8 operators"));
+}
+
+TEST(structure, not_catalog)
+{
+	auto w = Sample::Writer();
+	auto catalog = w.Add("<< /Type /Pages /Kids [] /Count 0 >>");
+	w.EndSection(catalog);
+	auto file = Sample::TempFile(w.Data());
+	auto doc = Document(file.Path());
+	auto report = DiffReport();
+	CHECK_THROWS(doc.Traverse(report), parse_error);
+}
+
+TEST(structure, deep_tree)
+{
+	// A chain of 10000 page tree nodes above a single page.
+	auto w = Sample::Writer();
+	auto catalog = w.Add("<< /Type /Catalog /Pages 2 0 R >>");
+	auto depth = size_t(10000);
+	for (auto i = size_t(0); i < depth; ++i)
+		w.Add("<< /Type /Pages /Kids [" + std::to_string(i + 3) + " 0 R] /Count 1 /Rotate " + std::to_string(i % 4 * 90) + " >>");
+	w.Add("<< /Type /Page /MediaBox [0 0 612 792] >>");
+	w.EndSection(catalog);
+	auto file = Sample::TempFile(w.Data());
+	auto doc = Document(file.Path());
+	CHECK_EQ(doc.GetPageCount(), size_t(1));
+	CHECK_EQ(doc.GetPage(0).obj_no, indirect_t(depth + 2));
+	CHECK_EQ(doc.GetPage(0).rotate.GetNumeric(), double((depth - 1) % 4 * 90));
+	CHECK_EQ(notes(doc).size(), size_t(3));
+}
+
+TEST(structure, cycle)
+{
+	auto w = Sample::Writer();
+	auto catalog = w.Add("<< /Type /Catalog /Pages 2 0 R >>");
+	w.Add("<< /Type /Pages /Kids [3 0 R] /Count 1 >>");
+	w.Add("<< /Type /Pages /Kids [2 0 R] /Count 1 >>");
+	w.EndSection(catalog);
+	auto file = Sample::TempFile(w.Data());
+	auto doc = Document(file.Path());
+	CHECK_THROWS(doc.GetPageCount(), parse_error);
+}
+
+TEST(structure, shared_resources)
+{
+	// Pages 0 and 1 share resources 6; page 2 has its own, which shares
+	// font 4 with them and adds font 5 and a direct one.
+	auto w = Sample::Writer();
+	auto catalog = w.Add("<< /Type /Catalog /Pages 2 0 R >>");
+	w.Add("<< /Type /Pages /Kids [7 0 R 8 0 R 9 0 R] /Count 3 >>");
+	w.Add("null");
+	w.Add("<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>");
+	w.Add("<< /Type /Font /Subtype /Type1 /BaseFont /Courier >>");
+	w.Add("<< /Font << /F1 4 0 R >> /ProcSet [/PDF /Text] >>");
+	w.Add("<< /Type /Page /Parent 2 0 R /Resources 6 0 R >>");
+	w.Add("<< /Type /Page /Parent 2 0 R /Resources 6 0 R >>");
+	w.Add("<< /Type /Page /Parent 2 0 R /Resources << /Font << /F1 4 0 R /F2 5 0 R"
+		  " /F3 << /Type /Font /Subtype /Type1 /BaseFont /Symbol >> >> >> >>");
+	w.EndSection(catalog);
+	auto file = Sample::TempFile(w.Data());
+	auto doc = Document(file.Path());
+
+	auto lines = notes(doc);
+	auto count = [&lines](const char *line) { return std::count(lines.begin(), lines.end(), line); };
+	CHECK_EQ(count("3 Resources"), std::ptrdiff_t(2));
+	CHECK_EQ(count("4 Font"), std::ptrdiff_t(3));
+	CHECK_EQ(count("4 ProcSet"), std::ptrdiff_t(1));
+
+	// Every run starts afresh.
+	CHECK(notes(doc) == lines);
+}
@@ -0,0 +1,116 @@
+#include "check.h"
+#include "pdf.h"
+#include "sample.h"
+#include <algorithm>
+
+using namespace PDF;
+
+TEST(xref_stream, entries)
+{
+	auto file = Sample::TempFile(Sample::Pages(250, Sample::Writer::Xref::Stream));
+	auto doc = Document(file.Path());
+	CHECK_EQ(doc.GetVersion(), std::string_view("1.5"));
+	CHECK_EQ(doc.GetRevisionCount(), size_t(1));
+
+	auto compressed = size_t(0);
+	for (const auto &entry : doc.GetRevision(0).entries)
+	{
+		if (!entry.container)
+			continue;
+		++compressed;
+		CHECK(entry.used);
+		CHECK(doc.GetXref(entry.container).object[Name::Type] == Name::ObjStm);
+	}
+	CHECK_EQ(compressed, size_t(250));
+	CHECK_EQ(doc.GetPageCount(), size_t(250));
+}
+
+TEST(xref_stream, compressed_objects)
+{
+	auto file = Sample::TempFile(Sample::Pages(250, Sample::Writer::Xref::Stream));
+	auto doc = Document(file.Path());
+
+	// Only the object stream holding the first page is inflated.
+	const auto &entries = doc.GetRevision(0).entries;
+	auto first = std::find_if(entries.begin(), entries.end(), [](const Revision::Entry &entry) { return entry.container; });
+	const auto &xref = doc.GetXref(first->obj_no);
+	CHECK(xref.container != 0);
+	CHECK_EQ(xref.index, size_t(0));
+	CHECK(xref.object[Name::Type] == Name::Page);
+	CHECK(xref.object[Name::Contents] == Object::Type::INDIRECT);
+	CHECK_EQ(doc.GetStatistics().object_streams.load(), size_t(1));
+
+	const auto &last = doc.GetXref(doc.LocatePage(249));
+	CHECK_EQ(last.index, size_t(49));
+	CHECK(last.object[Name::MediaBox] == Object::Type::ARRAY);
+}
+
+TEST(xref_stream, parallel_decode)
+{
+	auto file = Sample::TempFile(Sample::Pages(250, Sample::Writer::Xref::Stream));
+	auto options = Options();
+	options.jobs = 4;
+	auto doc = Document(file.Path(), options);
+	auto serial = Document(file.Path());
+
+	// Every object stream is inflated once, however many threads ask for it.
+	auto containers = std::vector<size_t>();
+	for (const auto &entry : doc.GetRevision(0).entries)
+		if (entry.container && std::find(containers.begin(), containers.end(), entry.container) == containers.end())
+			containers.push_back(entry.container);
+	CHECK(containers.size() > 1);
+	CHECK_EQ(doc.GetStatistics().object_streams.load(), containers.size());
+
+	for (auto i = size_t(0); i < doc.GetXrefSize(); ++i)
+		CHECK(doc.GetXref(i).object == serial.GetXref(i).object);
+}
+
+TEST(xref_stream, same_as_table)
+{
+	auto table = Sample::TempFile(Sample::Pages(120));
+	auto stream = Sample::TempFile(Sample::Pages(120, Sample::Writer::Xref::Stream));
+	auto l = Document(table.Path());
+	auto r = Document(stream.Path());
+	CHECK_EQ(l.GetPageCount(), r.GetPageCount());
+	for (auto i = size_t(0); i < l.GetPageCount(); ++i)
+		CHECK(l.GetXref(l.LocatePage(i)).object[Name::MediaBox] == r.GetXref(r.LocatePage(i)).object[Name::MediaBox]);
+}
+
+TEST(xref_stream, incremental_index)
+{
+	// A second section lists only the objects it replaces, in /Index runs.
+	auto w = Sample::Writer("1.5");
+	auto catalog = w.Add("<< /Type /Catalog /Pages 2 0 R >>");
+	w.Add("<< /Type /Pages /Kids [3 0 R] /Count 1 >>");
+	w.Add("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792] >>");
+	w.Add("(four)");
+	w.Add("(five)");
+	w.EndSection(catalog, Sample::Writer::Xref::Stream);
+	w.Add("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 100 100] >>", 3);
+	w.Add("(new five)", 5);
+	w.EndSection(catalog, Sample::Writer::Xref::Stream);
+
+	auto file = Sample::TempFile(w.Data());
+	auto doc = Document(file.Path());
+	CHECK_EQ(doc.GetRevisionCount(), size_t(2));
+	CHECK_EQ(doc.GetXref(4).object.GetString(), std::string_view("(four)"));
+	CHECK_EQ(doc.GetXref(5).object.GetString(), std::string_view("(new five)"));
+	CHECK_EQ(doc.GetXref(3).object[Name::MediaBox].GetArray()[2].GetNumeric(), 100.0);
+}
+
+TEST(xref_stream, indirect_filter)
+{
+	// The object stream names its filter through an indirect object.
+	auto w = Sample::Writer("1.5");
+	auto catalog = w.Add("<< /Type /Catalog /Pages 2 0 R >>");
+	w.Add("<< /Type /Pages /Kids [3 0 R] /Count 1 >>");
+	auto page = w.Reserve();
+	auto filter = w.Add("[/FlateDecode]");
+	w.AddObjectStream({{page, "<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792] >>"}}, 0, std::to_string(filter) + " 0 R");
+	w.EndSection(catalog, Sample::Writer::Xref::Stream);
+
+	auto file = Sample::TempFile(w.Data());
+	auto doc = Document(file.Path());
+	CHECK(doc.GetXref(page).object[Name::Type] == Name::Page);
+	CHECK_EQ(doc.GetPageCount(), size_t(1));
+}